@@ -33,6 +33,77 @@
 #include <Adafruit_LIS3DH.h>
 #include <Wire.h>
 
+/*!
+ *  g per LSB of the left-justified 16-bit output registers, indexed by
+ *  [lis3dh_range_t][lis3dh_mode_t]. Each entry folds in the shift down to
+ *  8/10/12 bits and the datasheet mg/digit sensitivity, including 16g being
+ *  3x (not 2x) the 8g sensitivity.
+ */
+static constexpr float lis3dh_g_per_lsb[4][3] = {
+    // LOW_POWER, NORMAL, HIGH_RESOLUTION
+    {16.0f / LIS3DH_LSB16_TO_KILO_LSB8, 4.0f / LIS3DH_LSB16_TO_KILO_LSB10,
+     1.0f / LIS3DH_LSB16_TO_KILO_LSB12}, // 2G
+    {32.0f / LIS3DH_LSB16_TO_KILO_LSB8, 8.0f / LIS3DH_LSB16_TO_KILO_LSB10,
+     2.0f / LIS3DH_LSB16_TO_KILO_LSB12}, // 4G
+    {64.0f / LIS3DH_LSB16_TO_KILO_LSB8, 16.0f / LIS3DH_LSB16_TO_KILO_LSB10,
+     4.0f / LIS3DH_LSB16_TO_KILO_LSB12}, // 8G
+    {192.0f / LIS3DH_LSB16_TO_KILO_LSB8, 48.0f / LIS3DH_LSB16_TO_KILO_LSB10,
+     12.0f / LIS3DH_LSB16_TO_KILO_LSB12}, // 16G
+};
+
+/*!
+ *  The same sensitivities as lis3dh_g_per_lsb, as integer multipliers in
+ *  units of 1/16 mg per LSB of the 16-bit output registers.
+ */
+static constexpr uint8_t lis3dh_mg16_per_lsb[4][3] = {
+    // LOW_POWER, NORMAL, HIGH_RESOLUTION
+    {1, 1, 1},    // 2G
+    {2, 2, 2},    // 4G
+    {4, 4, 4},    // 8G
+    {12, 12, 12}, // 16G
+};
+
+/*
+ * Helpers for the single producer, single consumer rings behind
+ * collectSamples() / popSample() and collectTap() / popTap(). The producer
+ * only writes head and the consumer only writes tail, and one slot is kept
+ * free to tell a full ring from an empty one, so neither side needs a lock.
+ */
+
+// Points a ring at new storage; the caller swaps the buffer pointer with
+// interrupts off too, as the producer may be an interrupt handler
+static void lis3dh_ring_reset(lis3dh_ring_t *ring, uint8_t size) {
+  ring->head = 0;
+  ring->tail = 0;
+  ring->size = size;
+}
+
+// Number of slots waiting for the consumer
+static uint8_t lis3dh_ring_used(const lis3dh_ring_t *ring) {
+  uint8_t size = ring->size;
+  return size ? (ring->head + size - ring->tail) % size : 0;
+}
+
+// Number of slots the producer may fill
+static uint8_t lis3dh_ring_free(const lis3dh_ring_t *ring) {
+  uint8_t size = ring->size;
+  return size ? size - 1 - lis3dh_ring_used(ring) : 0;
+}
+
+// Hands count filled slots to the consumer
+static void lis3dh_ring_publish(lis3dh_ring_t *ring, uint8_t count) {
+  // make sure the slots are stored before they are published
+  asm volatile("" ::: "memory");
+  ring->head = (ring->head + count) % ring->size;
+}
+
+// Hands the oldest slot back to the producer
+static void lis3dh_ring_release(lis3dh_ring_t *ring) {
+  // finish copying the slot before handing it back
+  asm volatile("" ::: "memory");
+  ring->tail = (ring->tail + 1) % ring->size;
+}
+
 /*!
  *  @brief  Instantiates a new LIS3DH class in I2C
  *  @param  Wi
@@ -86,6 +157,39 @@ Adafruit_LIS3DH::Adafruit_LIS3DH(int8_t cspin, int8_t mosipin, int8_t misopin,
   _frequency = frequency;
 }
 
+/*!
+ *   @brief  Copies the bus, pin and timestamp settings of another instance,
+ *           but not its bus device, which lives inside that instance; call
+ *           begin() on the copy before using it. Copy assignment is deleted
+ *           for the same reason.
+ *   @param  other
+ *           instance to copy
+ */
+Adafruit_LIS3DH::Adafruit_LIS3DH(const Adafruit_LIS3DH &other)
+    : Adafruit_Sensor(other), I2Cinterface(other.I2Cinterface),
+      SPIinterface(other.SPIinterface), _wai(other._wai), _cs(other._cs),
+      _mosi(other._mosi), _miso(other._miso), _sck(other._sck),
+      _i2caddr(other._i2caddr), _sensorID(other._sensorID),
+      _tempOffset(other._tempOffset), _frequency(other._frequency),
+      _clock(other._clock) {}
+
+/*!
+ *   @brief  Releases the bus device created by begin()
+ */
+Adafruit_LIS3DH::~Adafruit_LIS3DH(void) { releaseBus(); }
+
+/*!
+ *   @brief  Destroys the bus device in _busStorage, if there is one
+ */
+void Adafruit_LIS3DH::releaseBus(void) {
+  if (i2c_dev)
+    i2c_dev->~Adafruit_I2CDevice();
+  if (spi_dev)
+    spi_dev->~Adafruit_SPIDevice();
+  i2c_dev = NULL;
+  spi_dev = NULL;
+}
+
 /*!
  *  @brief  Setups the HW (reads coefficients values, etc.)
  *  @param  i2caddr
@@ -97,8 +201,12 @@ Adafruit_LIS3DH::Adafruit_LIS3DH(int8_t cspin, int8_t mosipin, int8_t misopin,
 bool Adafruit_LIS3DH::begin(uint8_t i2caddr, uint8_t nWAI) {
   _i2caddr = i2caddr;
   _wai = nWAI;
+
+  // begin() may be called again, e.g. after a sensor reset, so replace
+  // the bus device in place rather than allocating another one
+  releaseBus();
   if (I2Cinterface) {
-    i2c_dev = new Adafruit_I2CDevice(_i2caddr, I2Cinterface);
+    i2c_dev = new (_busStorage) Adafruit_I2CDevice(_i2caddr, I2Cinterface);
 
     if (!i2c_dev->begin()) {
       return false;
@@ -107,16 +215,18 @@ bool Adafruit_LIS3DH::begin(uint8_t i2caddr, uint8_t nWAI) {
 
     // SPIinterface->beginTransaction(SPISettings(500000, MSBFIRST, SPI_MODE0));
     if (_sck == -1) {
-      spi_dev = new Adafruit_SPIDevice(_cs,
-                                       _frequency,            // frequency
-                                       SPI_BITORDER_MSBFIRST, // bit order
-                                       SPI_MODE0,             // data mode
-                                       SPIinterface);
+      spi_dev = new (_busStorage)
+          Adafruit_SPIDevice(_cs,
+                             _frequency,            // frequency
+                             SPI_BITORDER_MSBFIRST, // bit order
+                             SPI_MODE0,             // data mode
+                             SPIinterface);
     } else {
-      spi_dev = new Adafruit_SPIDevice(_cs, _sck, _miso, _mosi,
-                                       _frequency,            // frequency
-                                       SPI_BITORDER_MSBFIRST, // bit order
-                                       SPI_MODE0);            // data mode
+      spi_dev = new (_busStorage)
+          Adafruit_SPIDevice(_cs, _sck, _miso, _mosi,
+                             _frequency,            // frequency
+                             SPI_BITORDER_MSBFIRST, // bit order
+                             SPI_MODE0);            // data mode
     }
 
     if (!spi_dev->begin()) {
@@ -124,30 +234,52 @@ bool Adafruit_LIS3DH::begin(uint8_t i2caddr, uint8_t nWAI) {
     }
   }
 
+  // pick the register address encoding and burst size for the bus once;
+  // the bus primitives still pick the I2C or SPI device per transaction,
+  // but no longer work out the address bits or burst size each time. For
+  // a bus fixed at compile time see Adafruit_LIS3DH_Lite
+  if (i2c_dev) {
+    _readFlags = LIS3DH_I2C_AUTOINC;
+    _writeFlags = LIS3DH_I2C_AUTOINC;
+    // keep each sample burst within the I2C buffer
+    _burstSamples = i2c_dev->maxBufferSize() / 6;
+    if (_burstSamples == 0)
+      _burstSamples = 1;
+  } else {
+    _readFlags = LIS3DH_SPI_AUTOINC | LIS3DH_SPI_READ;
+    _writeFlags = LIS3DH_SPI_AUTOINC; // [7] is cleared for write
+    _burstSamples = LIS3DH_FIFO_SIZE;
+  }
+
   /* Check connection */
   if (getDeviceID() != _wai) {
     /* No LIS3DH detected ... return false */
     // Serial.println(deviceid, HEX);
     return false;
   }
-  Adafruit_BusIO_Register _ctrl1 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL1, 1);
-  _ctrl1.write(0x07); // enable all axes, normal mode
-
-  // 400Hz rate
-  setDataRate(LIS3DH_DATARATE_400_HZ);
-
-  Adafruit_BusIO_Register _ctrl4 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL4, 1);
-  _ctrl4.write(0x88); // High res & BDU enabled
+  // start from the chip's actual configuration
+  if (!syncConfig())
+    return false;
+  // applyConfig() leaves BLE, self test and SIM alone, but a sensor left
+  // big-endian or in self test would decode garbage, so put them back to
+  // their defaults (only written if they are set)
+  if (!updateCtrl(LIS3DH_REG_CTRL4, 0x47, 0x00))
+    return false;
 
-  enableDRDY(true, 1);
+  lis3dh_config_t config;
+  getConfig(&config);
+  config.dataRate = LIS3DH_DATARATE_400_HZ; // 400Hz rate, all axes enabled
+  config.range = LIS3DH_RANGE_2_G;
+  config.mode = LIS3DH_MODE_HIGH_RESOLUTION; // High res & BDU enabled
+  config.blockDataUpdate = true;
+  config.int1 |= LIS3DH_INT1_DRDY1;
+  if (!applyConfig(&config))
+    return false;
 
   // Turn on orientation config
 
-  Adafruit_BusIO_Register _tmp_cfg = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_TEMPCFG, 1);
-  _tmp_cfg.write(0x80); // enable adcs
+  enableADC(true);          // enable adcs
+  enableTemperature(false); // ADC3 is an external input
 
   return true;
 }
@@ -157,85 +289,244 @@ bool Adafruit_LIS3DH::begin(uint8_t i2caddr, uint8_t nWAI) {
  *  @return WHO AM I value
  */
 uint8_t Adafruit_LIS3DH::getDeviceID(void) {
-  Adafruit_BusIO_Register _chip_id = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_WHOAMI, 1);
+  return readRegister(LIS3DH_REG_WHOAMI);
+}
 
-  return _chip_id.read();
+/*!
+ *  @brief  Re-reads TEMP_CFG_REG, CTRL_REG1 - CTRL_REG6, FIFO_CTRL_REG and
+ *          the click configuration into the driver's cached copy.
+ *
+ *  The range, mode, data rate and FIFO getters, getConfig() and read() work
+ *  from this cache, so call this if something other than this driver changed
+ *  those registers.
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::syncConfig(void) {
+  // TEMP_CFG_REG sits right before CTRL_REG1. CLICK_SRC sits between
+  // CLICK_CFG and CLICK_THS, and reading it would clear a latched click, so
+  // the click registers take two reads
+  uint8_t buffer[7];
+  if (!readRegisters(LIS3DH_REG_TEMPCFG, buffer, 7) ||
+      !readRegisters(LIS3DH_REG_FIFOCTRL, &_fifoCtrl, 1) ||
+      !readRegisters(LIS3DH_REG_CLICKCFG, &_clickCfg, 1) ||
+      !readRegisters(LIS3DH_REG_CLICKTHS, _clickTiming, 4))
+    return false;
+  _tempCfg = buffer[0];
+  memcpy(_ctrl, buffer + 1, 6);
+  _ctrl[4] &= ~0x80; // BOOT self-clears, never write it back
+  updateScale();
+  return true;
 }
+/*!
+ *  @brief  Gets the current configuration from the driver's cached copy
+ *  @param  config
+ *          configuration to fill
+ */
+void Adafruit_LIS3DH::getConfig(lis3dh_config_t *config) {
+  config->dataRate = getDataRate();
+  config->range = getRange();
+  config->mode = getPerformanceMode();
+  config->blockDataUpdate = _ctrl[3] & 0x80;
+  config->int1 = _ctrl[2];
+  config->int2 = _ctrl[5];
+  config->latchInt1 = _ctrl[4] & 0x08;
+  config->fifoMode = getFIFOMode();
+  config->fifoWatermark = getFIFOWatermark();
+  config->clickConfig = _clickCfg;
+  config->clickThreshold = _clickTiming[0];
+  config->clickTimeLimit = _clickTiming[1];
+  config->clickTimeLatency = _clickTiming[2];
+  config->clickTimeWindow = _clickTiming[3];
+}
+
+/*!
+ *  @brief  Applies a complete configuration with as few bus transactions as
+ *          possible
+ *
+ *  The new CTRL_REG1 - CTRL_REG6 values are compared with the cached copy and
+ *  the changed span is written in one auto-increment transaction; the FIFO
+ *  and click registers are only written when they differ. A single settling
+ *  delay covers any range or mode change. All axes are enabled.
+ *
+ *  @param  config
+ *          configuration to apply
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::applyConfig(const lis3dh_config_t *config) {
+  uint8_t ctrl[6];
+  bool lp = config->mode == LIS3DH_MODE_LOW_POWER;
+  bool hr = config->mode == LIS3DH_MODE_HIGH_RESOLUTION;
+
+  ctrl[0] = (config->dataRate << 4) | (lp ? 0x08 : 0x00) | 0x07;
+  ctrl[1] = _ctrl[1];
+  ctrl[2] = config->int1 & 0xFE;
+  // keep BLE, self test and SIM as they are
+  ctrl[3] = (_ctrl[3] & 0x47) | (config->blockDataUpdate ? 0x80 : 0x00) |
+            ((config->range & 0x03) << 4) | (hr ? 0x08 : 0x00);
+  ctrl[4] = (_ctrl[4] & ~0x48) |
+            ((config->fifoMode != LIS3DH_FIFO_BYPASS) ? 0x40 : 0x00) |
+            (config->latchInt1 ? 0x08 : 0x00);
+  ctrl[5] = config->int2 & 0xFA;
+
+  uint8_t settle = 0;
+  int8_t first = -1, last = -1;
+  for (uint8_t i = 0; i < 6; i++) {
+    if (ctrl[i] != _ctrl[i]) {
+      if (first < 0)
+        first = i;
+      last = i;
+    }
+  }
+  if (first >= 0) {
+    if (!writeRegisters(LIS3DH_REG_CTRL1 + first, ctrl + first,
+                        last - first + 1))
+      return false;
+
+    if ((ctrl[3] ^ _ctrl[3]) & 0x30)
+      settle = 15; // delay to let new range settle
+    else if (((ctrl[0] ^ _ctrl[0]) | (ctrl[3] ^ _ctrl[3])) & 0x08)
+      settle = hr ? 7 : 1; // turn-on transition time (worst case)
+
+    memcpy(_ctrl, ctrl, 6);
+    updateScale();
+  }
+
+  // keep the TR bit set up by captureShock()
+  uint8_t fifo_ctrl = (config->fifoMode << 6) | (_fifoCtrl & 0x20) |
+                      (config->fifoWatermark & 0x1F);
+  if (fifo_ctrl != _fifoCtrl) {
+    if (!writeRegister(LIS3DH_REG_FIFOCTRL, fifo_ctrl))
+      return false;
+    _fifoCtrl = fifo_ctrl;
+  }
+
+  if (config->clickConfig != _clickCfg) {
+    if (!writeRegister(LIS3DH_REG_CLICKCFG, config->clickConfig))
+      return false;
+    _clickCfg = config->clickConfig;
+  }
+
+  uint8_t timing[4] = {config->clickThreshold, config->clickTimeLimit,
+                       config->clickTimeLatency, config->clickTimeWindow};
+  if (memcmp(timing, _clickTiming, 4) != 0) {
+    // CLICK_THS, TIME_LIMIT, TIME_LATENCY and TIME_WINDOW are consecutive
+    if (!writeRegisters(LIS3DH_REG_CLICKTHS, timing, 4))
+      return false;
+    memcpy(_clickTiming, timing, 4);
+  }
+
+  if (settle)
+    delay(settle);
+  return true;
+}
+
 /*!
  *  @brief  Check to see if new data available
  *  @return true if there is new data available, false otherwise
  */
 bool Adafruit_LIS3DH::haveNewData(void) {
-  Adafruit_BusIO_Register status_2 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_STATUS2, 1);
-  Adafruit_BusIO_RegisterBits zyx_data_available =
-      Adafruit_BusIO_RegisterBits(&status_2, 1, 3);
-  return zyx_data_available.read();
+  // ZYXDA, bit 3 of STATUS_REG
+  return readRegister(LIS3DH_REG_STATUS2) & 0x08;
 }
 
 /*!
  *  @brief  Reads x y z values at once
  */
 void Adafruit_LIS3DH::read(void) {
-
-  uint8_t register_address = LIS3DH_REG_OUT_X_L;
-  if (i2c_dev) {
-    register_address |= 0x80; // set [7] for auto-increment
-  } else {
-    register_address |= 0x40; // set [6] for auto-increment
-    register_address |= 0x80; // set [7] for read
+  // fetch STATUS_REG in the same burst, to count overruns (ZYXOR)
+  uint8_t buffer[7] = {0};
+  if (readRegisters(LIS3DH_REG_STATUS2, buffer, 7)) {
+    _stats.samples++;
+    if (buffer[0] & 0x80)
+      _stats.overruns++;
   }
 
-  Adafruit_BusIO_Register xl_data = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, register_address, 6);
+  unpackXYZ(buffer + 1);
+  scaleXYZ();
+}
 
-  uint8_t buffer[6];
-  xl_data.read(buffer, 6);
+/*!
+ *  @brief  Reads x y z values only if new data is available, fetching the
+ *          status register and the data in one transaction
+ *  @param  overrun
+ *          optional, set to true if a sample was overwritten before being
+ *          read (ZYXOR)
+ *  @return true if new data was read, false otherwise
+ */
+bool Adafruit_LIS3DH::readIfNew(bool *overrun) {
+  // STATUS_REG sits right before OUT_X_L
+  uint8_t buffer[7];
+  if (!readRegisters(LIS3DH_REG_STATUS2, buffer, 7))
+    return false;
+
+  if (buffer[0] & 0x80) // ZYXOR
+    _stats.overruns++;
+  if (overrun)
+    *overrun = buffer[0] & 0x80;
+  if (!(buffer[0] & 0x08)) // ZYXDA
+    return false;
 
+  _stats.samples++;
+  unpackXYZ(buffer + 1);
+  scaleXYZ();
+  return true;
+}
+
+/*!
+ *  @brief  Stores raw little-endian OUT_X_L - OUT_Z_H bytes into x, y and z
+ *  @param  buffer
+ *          6 bytes read from OUT_X_L onwards
+ */
+void Adafruit_LIS3DH::unpackXYZ(const uint8_t *buffer) {
   x = buffer[0];
   x |= ((uint16_t)buffer[1]) << 8;
   y = buffer[2];
   y |= ((uint16_t)buffer[3]) << 8;
   z = buffer[4];
   z |= ((uint16_t)buffer[5]) << 8;
+}
 
-  uint8_t range = getRange();
-  uint8_t mode = getPerformanceMode();
-
-  // this scaling process accounts for the shift due to actually being 10 bits
-  // (normal mode) as well as the lsb=> mg conversion and the mg=> g conversion
-  // final value is raw_lsb => 10-bit lsb -> milli-gs -> gs
-
-  // depending on the range, we'll always convert the value to 8/10/12 bits and
-  // g's so we'll divide by LIS3DH_LSB16_TO_KILO_LSB10 (16000), _LSB8 or _LSB12:
-
-  // then we can then multiply the resulting value by the lsb value to get the
-  // value in g's
-
-  uint8_t lsb_value = 1;
-  if (range == LIS3DH_RANGE_2_G)
-    lsb_value = 4;
-  if (range == LIS3DH_RANGE_4_G)
-    lsb_value = 8;
-  if (range == LIS3DH_RANGE_8_G)
-    lsb_value = 16;
-  if (range == LIS3DH_RANGE_16_G)
-    lsb_value = 48;
-
-  float convert_from_LSB16 = 64000.0;
-  if (mode == LIS3DH_MODE_HIGH_RESOLUTION) {
-    lsb_value = lsb_value / 4; // 1 at 2G, 2 at 4G, 4 at 8G, 12 at 16G
-    convert_from_LSB16 = LIS3DH_LSB16_TO_KILO_LSB12;
-  } else if (mode == LIS3DH_MODE_NORMAL) {
-    convert_from_LSB16 = LIS3DH_LSB16_TO_KILO_LSB10;
-  } else if (mode == LIS3DH_MODE_LOW_POWER) {
-    lsb_value = lsb_value * 4; // 16 at 2G, 32 at 4G, 64 at 8G, 192 at 16G
-    convert_from_LSB16 = LIS3DH_LSB16_TO_KILO_LSB8;
-  }
-  x_g = lsb_value * ((float)x / convert_from_LSB16);
-  y_g = lsb_value * ((float)y / convert_from_LSB16);
-  z_g = lsb_value * ((float)z / convert_from_LSB16);
+/*!
+ *  @brief  Converts x, y and z into x_g, y_g and z_g
+ */
+void Adafruit_LIS3DH::scaleXYZ(void) {
+  // _scale accounts for the shift due to actually being 8/10/12 bits as well
+  // as the lsb => mg and mg => g conversions for the cached range and mode
+  int16_t raw[3] = {x, y, z};
+  float g[3];
+  convert(raw, g, 3, _scale);
+  x_g = g[0];
+  y_g = g[1];
+  z_g = g[2];
+}
+
+/*!
+ *  @brief  Reads x y z values at once and converts them to milli-g using
+ *          integer math only. x, y and z are updated, x_g, y_g and z_g are not.
+ *  @param  x_mg
+ *          x axis value in milli-g
+ *  @param  y_mg
+ *          y axis value in milli-g
+ *  @param  z_mg
+ *          z axis value in milli-g
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::readMilliG(int32_t *x_mg, int32_t *y_mg,
+                                 int32_t *z_mg) {
+  uint8_t buffer[6];
+  if (!readRegisters(LIS3DH_REG_OUT_X_L, buffer, 6))
+    return false;
+
+  _stats.samples++;
+  unpackXYZ(buffer);
+
+  int16_t raw[3] = {x, y, z};
+  int32_t mg[3];
+  convertMilliG(raw, mg, 3, getRange(), getPerformanceMode());
+  *x_mg = mg[0];
+  *y_mg = mg[1];
+  *z_mg = mg[2];
+  return true;
 }
 
 /*!
@@ -250,20 +541,8 @@ int16_t Adafruit_LIS3DH::readADC(uint8_t adc) {
   adc--; // switch to 0 indexed
 
   uint16_t value;
-  uint8_t reg = LIS3DH_REG_OUTADC1_L + (adc * 2);
-
-  if (i2c_dev) {
-    reg |= 0x80; // set [7] for auto-increment
-  } else {
-    reg |= 0x40; // set [6] for auto-increment
-    reg |= 0x80; // set [7] for read
-  }
-
   uint8_t buffer[2];
-  Adafruit_BusIO_Register adc_data =
-      Adafruit_BusIO_Register(i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, reg, 2);
-
-  adc_data.read(buffer, 2);
+  readRegisters(LIS3DH_REG_OUTADC1_L + (adc * 2), buffer, 2);
 
   value = buffer[0];
   value |= ((uint16_t)buffer[1]) << 8;
@@ -271,6 +550,78 @@ int16_t Adafruit_LIS3DH::readADC(uint8_t adc) {
   return value;
 }
 
+/*!
+ *  @brief  Read all three auxilary ADC channels in one transaction
+ *
+ *  With the temperature sensor enabled adc3 holds the temperature instead of
+ *  the ADC3 input.
+ *
+ *  @param  adc1
+ *          ADC1 value
+ *  @param  adc2
+ *          ADC2 value
+ *  @param  adc3
+ *          ADC3 value
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::readADCs(int16_t *adc1, int16_t *adc2, int16_t *adc3) {
+  uint8_t buffer[6];
+  if (!readRegisters(LIS3DH_REG_OUTADC1_L, buffer, 6))
+    return false;
+
+  *adc1 = buffer[0] | ((uint16_t)buffer[1] << 8);
+  *adc2 = buffer[2] | ((uint16_t)buffer[3] << 8);
+  *adc3 = buffer[4] | ((uint16_t)buffer[5] << 8);
+  return true;
+}
+
+/*!
+ *  @brief  Enable or disable the auxilary ADC (ADC_EN in TEMP_CFG_REG)
+ *  @param  enable_adc
+ *          true to enable the ADC, false to disable it
+ */
+void Adafruit_LIS3DH::enableADC(bool enable_adc) {
+  updateTempCfg(0x80, enable_adc ? 0x80 : 0x00);
+}
+
+/*!
+ *  @brief  Enable or disable the temperature sensor (TEMP_EN in
+ *          TEMP_CFG_REG). The temperature is read through ADC3, so enabling
+ *          it also enables the ADC.
+ *  @param  enable_temp
+ *          true to enable the temperature sensor, false to disable it
+ */
+void Adafruit_LIS3DH::enableTemperature(bool enable_temp) {
+  if (enable_temp)
+    updateTempCfg(0xC0, 0xC0);
+  else
+    updateTempCfg(0x40, 0x00);
+}
+
+/*!
+ *  @brief  Read the temperature sensor, see enableTemperature()
+ *
+ *  The sensor only measures changes in temperature at 1 digit/C, so the
+ *  result is relative to setTemperatureOffset(), 25C by default.
+ *
+ *  @return Temperature in degrees C
+ */
+float Adafruit_LIS3DH::readTemperature(void) {
+  uint8_t buffer[2];
+  readRegisters(LIS3DH_REG_OUTADC3_L, buffer, 2);
+  // 8 bit two's complement, left justified in OUT_ADC3
+  return _tempOffset + (int8_t)buffer[1];
+}
+
+/*!
+ *  @brief  Calibrate readTemperature() against a known temperature
+ *  @param  offset
+ *          temperature in degrees C when the sensor reads 0
+ */
+void Adafruit_LIS3DH::setTemperatureOffset(float offset) {
+  _tempOffset = offset;
+}
+
 /*!
  *   @brief  Set INT to output for single or double click
  *   @param  c
@@ -290,52 +641,31 @@ int16_t Adafruit_LIS3DH::readADC(uint8_t adc) {
 void Adafruit_LIS3DH::setClick(uint8_t c, uint8_t clickthresh,
                                uint8_t timelimit, uint8_t timelatency,
                                uint8_t timewindow) {
-
-  Adafruit_BusIO_Register ctrl3 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL3, 1);
-  Adafruit_BusIO_RegisterBits i1_click =
-      Adafruit_BusIO_RegisterBits(&ctrl3, 1, 7);
-
-  Adafruit_BusIO_Register click_cfg = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CLICKCFG, 1);
+  lis3dh_config_t config;
+  getConfig(&config);
 
   if (!c) {
     // disable int
-    i1_click.write(0); // disable i1 click
-    click_cfg.write(0);
+    config.int1 &= ~LIS3DH_INT1_CLICK; // disable i1 click
+    config.clickConfig = 0;
+    applyConfig(&config);
     return;
   }
   // else...
 
-  i1_click.write(1); // enable i1 click
-
-  Adafruit_BusIO_Register ctrl5 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL5, 1);
-
-  Adafruit_BusIO_RegisterBits int1_latch_bit =
-      Adafruit_BusIO_RegisterBits(&ctrl5, 1, 3);
-  int1_latch_bit.write(true);
+  config.int1 |= LIS3DH_INT1_CLICK; // enable i1 click
+  config.latchInt1 = true;
 
   if (c == 1)
-    click_cfg.write(0x15); // turn on all axes & singletap
+    config.clickConfig = 0x15; // turn on all axes & singletap
   if (c == 2)
-    click_cfg.write(0x2A); // turn on all axes & doubletap
-
-  Adafruit_BusIO_Register click_ths = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CLICKTHS, 1);
-  click_ths.write(clickthresh); // arbitrary
-
-  Adafruit_BusIO_Register time_limit = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_TIMELIMIT, 1);
-  time_limit.write(timelimit); // arbitrary
+    config.clickConfig = 0x2A; // turn on all axes & doubletap
 
-  Adafruit_BusIO_Register time_latency = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_TIMELATENCY, 1);
-  time_latency.write(timelatency); // arbitrary
-
-  Adafruit_BusIO_Register time_window = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_TIMEWINDOW, 1);
-  time_window.write(timewindow); // arbitrary
+  config.clickThreshold = clickthresh;   // arbitrary
+  config.clickTimeLimit = timelimit;     // arbitrary
+  config.clickTimeLatency = timelatency; // arbitrary
+  config.clickTimeWindow = timewindow;   // arbitrary
+  applyConfig(&config);
 }
 
 /*!
@@ -343,10 +673,122 @@ void Adafruit_LIS3DH::setClick(uint8_t c, uint8_t clickthresh,
  *   @return register LIS3DH_REG_CLICKSRC
  */
 uint8_t Adafruit_LIS3DH::getClick(void) {
-  Adafruit_BusIO_Register click_reg = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CLICKSRC, 1);
+  return readRegister(LIS3DH_REG_CLICKSRC);
+}
+
+/*!
+ *   @brief  Set up single or double tap detection in physical units, latched
+ *           on INT1 until collectTap() or getClick() reads CLICK_SRC
+ *   @param  c
+ *           0 = off, 1 = single tap, 2 = double tap (see setClick())
+ *   @param  threshold_mg
+ *           tap threshold in milli-g, scaled by the current range
+ *   @param  timelimit_ms
+ *           longest a tap may stay above the threshold
+ *   @param  timelatency_ms
+ *           dead time after the first tap of a double tap
+ *   @param  timewindow_ms
+ *           time after the latency in which the second tap must start
+ *
+ *   Times are converted with the current data rate, so set the data rate
+ *   and range first.
+ */
+void Adafruit_LIS3DH::setTap(uint8_t c, uint16_t threshold_mg,
+                             uint16_t timelimit_ms, uint16_t timelatency_ms,
+                             uint16_t timewindow_ms) {
+  // CLICK_THS LSB is full scale / 128, i.e. 15.625mg at 2G
+  uint32_t full_scale = 2000UL << getRange();
+  uint32_t threshold = (threshold_mg * 128UL + full_scale / 2) / full_scale;
+  if (threshold < 1)
+    threshold = 1;
+  if (threshold > 127)
+    threshold = 127;
+
+  // TIME_LIMIT, TIME_LATENCY and TIME_WINDOW LSB are 1/ODR
+  uint32_t period = getSamplePeriod();
+  uint16_t ms[3] = {timelimit_ms, timelatency_ms, timewindow_ms};
+  uint8_t ticks[3] = {0};
+  for (uint8_t i = 0; i < 3; i++) {
+    uint32_t t = period ? (ms[i] * 1000UL + period / 2) / period : 0;
+    uint8_t max = (i == 0) ? 127 : 255; // TIME_LIMIT is 7 bits
+    ticks[i] = (t > max) ? max : t;
+  }
+
+  // LIR_Click (CLICK_THS bit 7) latches the interrupt until CLICK_SRC is read
+  setClick(c, threshold | 0x80, ticks[0], ticks[1], ticks[2]);
+}
+
+/*!
+ *  @brief  Sets up the queue collectTap() fills and popTap() empties
+ *
+ *  Like setSampleBuffer(), collectTap() is the single producer and popTap()
+ *  the single consumer, and one slot is kept free.
+ *
+ *  @param  buffer
+ *          storage for the queue, owned by the caller
+ *  @param  size
+ *          number of slots in buffer, at least 2
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::setTapBuffer(lis3dh_tap_t *buffer, uint8_t size) {
+  if ((buffer == NULL) || (size < 2))
+    return false;
+  noInterrupts();
+  _taps = buffer;
+  lis3dh_ring_reset(&_tapRing, size);
+  interrupts();
+  return true;
+}
+
+/*!
+ *  @brief  Reads CLICK_SRC and queues the tap it reports, if any
+ *
+ *  Attach this to the INT1 pin after setTap() or setClick() and
+ *  setTapBuffer(), or call it from loop() when woken by the interrupt.
+ *  Reading CLICK_SRC clears the latched interrupt, ready for the next tap.
+ *  Turn off the DRDY interrupt (see enableDRDY()) so INT1 is only raised by
+ *  taps.
+ *
+ *  @return true if a tap was queued; false if there was none, the bus read
+ *          failed or the queue is full or not set up
+ */
+bool Adafruit_LIS3DH::collectTap(void) {
+  uint8_t src;
+  if (!readRegisters(LIS3DH_REG_CLICKSRC, &src, 1) || !(src & 0x40)) // IA
+    return false;
+  if (lis3dh_ring_free(&_tapRing) == 0)
+    return false;
+
+  // CLICK_SRC: [-, IA, DCLICK, SCLICK, Sign, Z, Y, X]
+  lis3dh_tap_t *tap = &_taps[_tapRing.head];
+  tap->axes = src & 0x07;
+  tap->negative = src & 0x08;
+  tap->doubleTap = src & 0x20;
+  tap->timestamp = now();
+  lis3dh_ring_publish(&_tapRing, 1);
+  return true;
+}
 
-  return click_reg.read();
+/*!
+ *  @brief  Gets the number of taps waiting in the queue
+ *  @return Number of taps
+ */
+uint8_t Adafruit_LIS3DH::tapsAvailable(void) {
+  return lis3dh_ring_used(&_tapRing);
+}
+
+/*!
+ *  @brief  Takes the oldest tap from the queue
+ *  @param  tap
+ *          tap to fill
+ *  @return true if a tap was available
+ */
+bool Adafruit_LIS3DH::popTap(lis3dh_tap_t *tap) {
+  if (lis3dh_ring_used(&_tapRing) == 0)
+    return false;
+  *tap = _taps[_tapRing.tail];
+  lis3dh_ring_release(&_tapRing);
+  return true;
 }
 
 /*!
@@ -354,10 +796,75 @@ uint8_t Adafruit_LIS3DH::getClick(void) {
  *   @return register LIS3DH_REG_INT1SRC
  */
 uint8_t Adafruit_LIS3DH::readAndClearInterrupt(void) {
-  Adafruit_BusIO_Register int_reg = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_INT1SRC, 1);
+  return readRegister(LIS3DH_REG_INT1SRC);
+}
+
+/*!
+ *   @brief  Sets up one of the two inertial interrupt generators, for example
+ *           wake-up on motion (LIS3DH_INT_OR with the HIGH events) or
+ *           free-fall (LIS3DH_INT_AND with the LOW events)
+ *   @param  generator
+ *           interrupt generator, 1 or 2
+ *   @param  mode
+ *           how the events are combined, e.g. LIS3DH_INT_OR
+ *   @param  events
+ *           LIS3DH_INT_XLOW etc. events to react to, 0 to disable
+ *   @param  threshold_mg
+ *           threshold in milli-g, scaled by the current range
+ *   @param  duration
+ *           minimum event duration in samples (1/ODR), 0 to 127
+ *   @param  int_pin
+ *           pin to signal the interrupt on, 1 or 2, or 0 for none
+ *   @param  latch
+ *           true to hold the interrupt until readInterruptSource(); only
+ *           the INT1 pin can latch generator 1 and INT2 generator 2
+ *   @return true: success false: failure
+ */
+bool Adafruit_LIS3DH::setInterruptGenerator(uint8_t generator,
+                                            lis3dh_int_mode_t mode,
+                                            uint8_t events,
+                                            uint16_t threshold_mg,
+                                            uint8_t duration, uint8_t int_pin,
+                                            bool latch) {
+  if ((generator < 1) || (generator > 2) || (int_pin > 2))
+    return false;
+
+  // INTx_THS LSB is 16mg at 2G, 32mg at 4G, 62mg at 8G and 186mg at 16G
+  static const uint8_t mg_per_lsb[4] = {16, 32, 62, 186};
+  uint16_t lsb = mg_per_lsb[getRange()];
+  uint16_t threshold = (threshold_mg + (lsb / 2)) / lsb;
+  if (threshold > 127)
+    threshold = 127;
+
+  // INTx_THS and INTx_DURATION are consecutive
+  uint8_t cfg_reg = (generator == 1) ? LIS3DH_REG_INT1CFG : LIS3DH_REG_INT2CFG;
+  uint8_t timing[2] = {(uint8_t)threshold, (uint8_t)(duration & 0x7F)};
+  if (!writeRegisters(cfg_reg + 2, timing, 2) ||
+      !writeRegister(cfg_reg, mode | (events & 0x3F)))
+    return false;
+
+  // route IA1/IA2 to the chosen pin, the same bit in CTRL_REG3 and CTRL_REG6
+  uint8_t ia = (generator == 1) ? LIS3DH_INT1_IA1 : LIS3DH_INT1_IA2;
+  bool routed = events && int_pin;
+  // LIR_INT1 / LIR_INT2 in CTRL_REG5
+  uint8_t lir = (generator == 1) ? 0x08 : 0x02;
+  return updateCtrl(LIS3DH_REG_CTRL3, ia,
+                    (routed && (int_pin == 1)) ? ia : 0x00) &&
+         updateCtrl(LIS3DH_REG_CTRL6, ia,
+                    (routed && (int_pin == 2)) ? ia : 0x00) &&
+         updateCtrl(LIS3DH_REG_CTRL5, lir, latch ? lir : 0x00);
+}
 
-  return int_reg.read();
+/*!
+ *   @brief  Reads the source register of an interrupt generator, which also
+ *           clears a latched interrupt
+ *   @param  generator
+ *           interrupt generator, 1 or 2
+ *   @return register LIS3DH_REG_INT1SRC or LIS3DH_REG_INT2SRC
+ */
+uint8_t Adafruit_LIS3DH::readInterruptSource(uint8_t generator) {
+  return readRegister((generator == 2) ? LIS3DH_REG_INT2SRC
+                                       : LIS3DH_REG_INT1SRC);
 }
 
 /**
@@ -369,17 +876,10 @@ uint8_t Adafruit_LIS3DH::readAndClearInterrupt(void) {
  * @return true: success false: failure
  */
 bool Adafruit_LIS3DH::enableDRDY(bool enable_drdy, uint8_t int_pin) {
-  Adafruit_BusIO_Register _ctrl3 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL3, 1);
-  Adafruit_BusIO_RegisterBits _drdy1_int_enable =
-      Adafruit_BusIO_RegisterBits(&_ctrl3, 1, 4);
-  Adafruit_BusIO_RegisterBits _drdy2_int_enable =
-      Adafruit_BusIO_RegisterBits(&_ctrl3, 1, 3);
-
   if (int_pin == 1) {
-    return _drdy1_int_enable.write(enable_drdy);
+    return updateCtrl(LIS3DH_REG_CTRL3, 0x10, enable_drdy ? 0x10 : 0x00);
   } else if (int_pin == 2) {
-    return _drdy2_int_enable.write(enable_drdy);
+    return updateCtrl(LIS3DH_REG_CTRL3, 0x08, enable_drdy ? 0x08 : 0x00);
   } else {
     return false;
   }
@@ -395,33 +895,25 @@ bool Adafruit_LIS3DH::enableDRDY(bool enable_drdy, uint8_t int_pin) {
  *          mode - low power, normal, high resolution e.g. LIS3DH_MODE_LOW_POWER
  */
 void Adafruit_LIS3DH::setPerformanceMode(lis3dh_mode_t mode) {
-  // low power bit is in CTRL1, 4th bit from right
-  Adafruit_BusIO_Register _ctrl1 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL1, 1);
-  Adafruit_BusIO_RegisterBits ctrl1_mode_bits =
-      Adafruit_BusIO_RegisterBits(&_ctrl1, 1, 3);
-  // high res bit is in CTRL4, 4th bit from right
-  Adafruit_BusIO_Register _ctrl4 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL4, 1);
-  Adafruit_BusIO_RegisterBits ctrl4_mode_bits =
-      Adafruit_BusIO_RegisterBits(&_ctrl4, 1, 3);
+  // low power bit is in CTRL1, high res bit is in CTRL4, both 4th bit from
+  // right
   switch (mode) {
   case LIS3DH_MODE_LOW_POWER:
     // set HR bit low (CTRL4) and LP bit high (CTRL1)
-    ctrl4_mode_bits.write(0);
-    ctrl1_mode_bits.write(1);
+    updateCtrl(LIS3DH_REG_CTRL4, 0x08, 0x00);
+    updateCtrl(LIS3DH_REG_CTRL1, 0x08, 0x08);
     delay(1); // turn-on transition time (worst case)
     break;
   case LIS3DH_MODE_NORMAL:
     // set HR bit low (CTRL4) and LP bit low (CTRL1)
-    ctrl1_mode_bits.write(0);
-    ctrl4_mode_bits.write(0);
+    updateCtrl(LIS3DH_REG_CTRL1, 0x08, 0x00);
+    updateCtrl(LIS3DH_REG_CTRL4, 0x08, 0x00);
     delay(1); // turn-on transition time (worst case)
     break;
   case LIS3DH_MODE_HIGH_RESOLUTION:
     // set HR bit high (CTRL4) and LP bit low (CTRL1)
-    ctrl1_mode_bits.write(0);
-    ctrl4_mode_bits.write(1);
+    updateCtrl(LIS3DH_REG_CTRL1, 0x08, 0x00);
+    updateCtrl(LIS3DH_REG_CTRL4, 0x08, 0x08);
     delay(7); // turn-on transition time (worst case)
     break;
   }
@@ -432,19 +924,9 @@ void Adafruit_LIS3DH::setPerformanceMode(lis3dh_mode_t mode) {
  *   @return Returns performance mode value
  */
 lis3dh_mode_t Adafruit_LIS3DH::getPerformanceMode(void) {
-  // low power bit is in CTRL1, 4th bit from right
-  Adafruit_BusIO_Register _ctrl1 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL1, 1);
-  Adafruit_BusIO_RegisterBits ctrl1_mode_bits =
-      Adafruit_BusIO_RegisterBits(&_ctrl1, 1, 3);
-  // high res bit is in CTRL4, 4th bit from right
-  Adafruit_BusIO_Register _ctrl4 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL4, 1);
-  Adafruit_BusIO_RegisterBits ctrl4_mode_bits =
-      Adafruit_BusIO_RegisterBits(&_ctrl4, 1, 3);
-
-  bool lp = ctrl1_mode_bits.read() == 1;
-  bool hr = ctrl4_mode_bits.read() == 1;
+  // low power bit is in CTRL1, high res bit is in CTRL4
+  bool lp = _ctrl[0] & 0x08;
+  bool hr = _ctrl[3] & 0x08;
   if (!lp && !hr) {
     return LIS3DH_MODE_NORMAL;
   } else if (lp && !hr) {
@@ -459,14 +941,10 @@ lis3dh_mode_t Adafruit_LIS3DH::getPerformanceMode(void) {
  *           range value
  */
 void Adafruit_LIS3DH::setRange(lis3dh_range_t range) {
-
-  Adafruit_BusIO_Register _ctrl4 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL4, 1);
-
-  Adafruit_BusIO_RegisterBits range_bits =
-      Adafruit_BusIO_RegisterBits(&_ctrl4, 2, 4);
-  range_bits.write(range);
-  delay(15); // delay to let new setting settle
+  if (range == getRange())
+    return;
+  if (updateCtrl(LIS3DH_REG_CTRL4, 0x30, range << 4))
+    delay(15); // delay to let new setting settle
 }
 
 /*!
@@ -474,12 +952,7 @@ void Adafruit_LIS3DH::setRange(lis3dh_range_t range) {
  *  @return Returns g range value
  */
 lis3dh_range_t Adafruit_LIS3DH::getRange(void) {
-  Adafruit_BusIO_Register _ctrl4 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL4, 1);
-
-  Adafruit_BusIO_RegisterBits range_bits =
-      Adafruit_BusIO_RegisterBits(&_ctrl4, 2, 4);
-  return (lis3dh_range_t)range_bits.read();
+  return (lis3dh_range_t)((_ctrl[3] >> 4) & 0x03);
 }
 
 /*!
@@ -488,12 +961,7 @@ lis3dh_range_t Adafruit_LIS3DH::getRange(void) {
  *          data rate value
  */
 void Adafruit_LIS3DH::setDataRate(lis3dh_dataRate_t dataRate) {
-  Adafruit_BusIO_Register _ctrl1 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL1, 1);
-  Adafruit_BusIO_RegisterBits data_rate_bits =
-      Adafruit_BusIO_RegisterBits(&_ctrl1, 4, 4);
-
-  data_rate_bits.write(dataRate);
+  updateCtrl(LIS3DH_REG_CTRL1, 0xF0, dataRate << 4);
 }
 
 /*!
@@ -501,12 +969,687 @@ void Adafruit_LIS3DH::setDataRate(lis3dh_dataRate_t dataRate) {
  *   @return Returns Data Rate value
  */
 lis3dh_dataRate_t Adafruit_LIS3DH::getDataRate(void) {
-  Adafruit_BusIO_Register _ctrl1 = Adafruit_BusIO_Register(
-      i2c_dev, spi_dev, ADDRBIT8_HIGH_TOREAD, LIS3DH_REG_CTRL1, 1);
-  Adafruit_BusIO_RegisterBits data_rate_bits =
-      Adafruit_BusIO_RegisterBits(&_ctrl1, 4, 4);
+  return (lis3dh_dataRate_t)(_ctrl[0] >> 4);
+}
 
-  return (lis3dh_dataRate_t)data_rate_bits.read();
+/*!
+ *   @brief  Gets the time between samples at the cached data rate
+ *   @return Sample period in microseconds, 0 when powered down
+ */
+uint32_t Adafruit_LIS3DH::getSamplePeriod(void) {
+  switch (getDataRate()) {
+  case LIS3DH_DATARATE_1_HZ:
+    return 1000000;
+  case LIS3DH_DATARATE_10_HZ:
+    return 100000;
+  case LIS3DH_DATARATE_25_HZ:
+    return 40000;
+  case LIS3DH_DATARATE_50_HZ:
+    return 20000;
+  case LIS3DH_DATARATE_100_HZ:
+    return 10000;
+  case LIS3DH_DATARATE_200_HZ:
+    return 5000;
+  case LIS3DH_DATARATE_400_HZ:
+    return 2500;
+  case LIS3DH_DATARATE_LOWPOWER_1K6HZ:
+    return 625;
+  case LIS3DH_DATARATE_LOWPOWER_5KHZ:
+    // 5.376 kHz in low power mode, 1.344 kHz otherwise
+    return (getPerformanceMode() == LIS3DH_MODE_LOW_POWER) ? 186 : 744;
+  default:
+    return 0;
+  }
+}
+
+/*!
+ *   @brief  Sets the clock used to timestamp samples and taps. Sensor
+ *           events keep the unified sensor millis() timestamps, so they
+ *           don't wrap with a 32 bit microsecond clock
+ *   @param  clock
+ *           function returning microseconds, or NULL for micros()
+ */
+void Adafruit_LIS3DH::setClockSource(lis3dh_clock_t clock) { _clock = clock; }
+
+/*!
+ *   @brief  Reads the timestamp clock
+ *   @return Current time in microseconds
+ */
+uint32_t Adafruit_LIS3DH::now(void) { return _clock ? _clock() : micros(); }
+
+/*!
+ *  @brief  Sets the FIFO mode, enabling the FIFO for anything but bypass
+ *  @param  mode
+ *          FIFO mode, e.g. LIS3DH_FIFO_STREAM
+ */
+void Adafruit_LIS3DH::setFIFOMode(lis3dh_fifo_mode_t mode) {
+  updateCtrl(LIS3DH_REG_CTRL5, 0x40,
+             (mode != LIS3DH_FIFO_BYPASS) ? 0x40 : 0x00); // FIFO_EN
+
+  // FM1-FM0 are the top two bits of FIFO_CTRL_REG
+  uint8_t fifo_ctrl = (_fifoCtrl & 0x3F) | (mode << 6);
+  if (writeRegister(LIS3DH_REG_FIFOCTRL, fifo_ctrl))
+    _fifoCtrl = fifo_ctrl;
+}
+
+/*!
+ *  @brief  Gets the FIFO mode
+ *  @return Returns FIFO mode value
+ */
+lis3dh_fifo_mode_t Adafruit_LIS3DH::getFIFOMode(void) {
+  return (lis3dh_fifo_mode_t)(_fifoCtrl >> 6);
+}
+
+/*!
+ *  @brief  Gets the number of unread samples in the FIFO
+ *  @return Number of samples, 0 to LIS3DH_FIFO_SIZE
+ */
+uint8_t Adafruit_LIS3DH::getFIFOCount(void) {
+  uint8_t src = readRegister(LIS3DH_REG_FIFOSRC);
+  uint8_t count = src & 0x1F; // FSS4-0
+  if (src & 0x40) {           // OVRN_FIFO, all 32 slots are full
+    _stats.fifoOverflows++;
+    count = LIS3DH_FIFO_SIZE;
+  }
+  if (count > _stats.maxFIFOLevel)
+    _stats.maxFIFOLevel = count;
+  return count;
+}
+
+/*!
+ *  @brief  Drains pending samples from the FIFO
+ *
+ *  The FIFO depth is read from FIFO_SRC, then the samples are read with
+ *  auto-increment from OUT_X_L; with the FIFO enabled the chip wraps back to
+ *  OUT_X_L after OUT_Z_H, so one transaction can return many samples.
+ *
+ *  @param  samples
+ *          buffer to fill, oldest sample first
+ *  @param  maxCount
+ *          maximum number of samples to read
+ *  @return Number of samples read
+ */
+uint8_t Adafruit_LIS3DH::readFIFO(lis3dh_sample_t *samples,
+                                  uint8_t maxCount) {
+  uint8_t depth = getFIFOCount();
+  return readFIFO(samples, maxCount, depth, now());
+}
+
+/*!
+ *  @brief  Drains samples from the FIFO when its depth is already known,
+ *          e.g. from getFIFOCount(), saving a FIFO_SRC read
+ *
+ *  Samples that arrived after the depth was read stay in the FIFO for the
+ *  next drain, so the timestamps stay relative to when it was read.
+ *
+ *  @param  samples
+ *          buffer to fill, oldest sample first
+ *  @param  maxCount
+ *          maximum number of samples to read
+ *  @param  depth
+ *          number of samples the FIFO held
+ *  @param  counted
+ *          now() when the depth was read, the time of the newest sample
+ *  @return Number of samples read
+ */
+uint8_t Adafruit_LIS3DH::readFIFO(lis3dh_sample_t *samples, uint8_t maxCount,
+                                  uint8_t depth, uint32_t counted) {
+  uint8_t count = (depth > maxCount) ? maxCount : depth;
+  if (!readSampleArray(samples, count, counted, depth - count))
+    return 0;
+  return count;
+}
+
+/*!
+ *  @brief  Sets the FIFO watermark level. The WTM flag in FIFO_SRC, and the
+ *          watermark interrupt, are raised once the FIFO holds more samples
+ *  @param  level
+ *          watermark level, 0 to 31
+ */
+void Adafruit_LIS3DH::setFIFOWatermark(uint8_t level) {
+  // FTH4-0 are the bottom five bits of FIFO_CTRL_REG
+  uint8_t fifo_ctrl = (_fifoCtrl & 0xE0) | (level & 0x1F);
+  if (writeRegister(LIS3DH_REG_FIFOCTRL, fifo_ctrl))
+    _fifoCtrl = fifo_ctrl;
+}
+
+/*!
+ *  @brief  Gets the FIFO watermark level
+ *  @return Watermark level, 0 to 31
+ */
+uint8_t Adafruit_LIS3DH::getFIFOWatermark(void) { return _fifoCtrl & 0x1F; }
+
+/*!
+ *  @brief  Enable or disable the FIFO watermark and overrun interrupts
+ *
+ *  The LIS3DH can only route the FIFO interrupts to INT1 (CTRL_REG3).
+ *
+ *  @param  watermark
+ *          true to raise INT1 when the watermark level is passed
+ *  @param  overrun
+ *          true to raise INT1 when the FIFO is full
+ *  @param  int_pin
+ *          interrupt pin, must be 1
+ *  @return true: success false: failure
+ */
+bool Adafruit_LIS3DH::enableFIFOInterrupts(bool watermark, bool overrun,
+                                           uint8_t int_pin) {
+  if (int_pin != 1)
+    return false;
+  // I1_WTM is bit 2, I1_OVERRUN is bit 1
+  return updateCtrl(LIS3DH_REG_CTRL3, 0x06,
+                    (watermark ? 0x04 : 0x00) | (overrun ? 0x02 : 0x00));
+}
+
+/*!
+ *  @brief  Drains the samples that raised the watermark in one burst
+ *
+ *  Meant for the watermark interrupt handler: WTM is raised once the FIFO
+ *  holds more than the watermark level, so it is known to hold at least
+ *  getFIFOWatermark() + 1 samples and FIFO_SRC is not read first. The
+ *  newest of them is timestamped now.
+ *
+ *  @param  samples
+ *          buffer to fill, room for getFIFOWatermark() + 1 samples
+ *  @return Number of samples read
+ */
+uint8_t Adafruit_LIS3DH::readFIFOWatermark(lis3dh_sample_t *samples) {
+  uint8_t count = getFIFOWatermark() + 1;
+  if (!readSampleArray(samples, count, now(), 0))
+    return 0;
+  return count;
+}
+
+/*!
+ *  @brief  Captures the samples around an inertial event, letting the FIFO
+ *          hold the pre-trigger window instead of sampling continuously
+ *
+ *  The FIFO streams in trigger mode until the interrupt generator fires on
+ *  its pin, then freezes. The frozen window is drained and the FIFO is
+ *  restarted in stream mode to collect the post-trigger burst until the
+ *  buffer is full. Set the generator up first with setInterruptGenerator(),
+ *  latched and routed to INT1 or INT2. The FIFO setup is put back
+ *  afterwards, with the FIFO emptied, so a streaming sensor carries on.
+ *
+ *  The hardware triggers on the whole pin signal, so while armed every other
+ *  source routed to that pin (e.g. the DRDY interrupt begin() enables on
+ *  INT1) is switched off, and the routing is restored afterwards.
+ *
+ *  The pre-trigger samples are timestamped from when the trigger was seen,
+ *  and a few samples may be lost while the FIFO restarts; the timestamps
+ *  show the gap.
+ *
+ *  @param  samples
+ *          buffer to fill, oldest sample first
+ *  @param  maxCount
+ *          size of the buffer, at least LIS3DH_FIFO_SIZE; anything beyond
+ *          the pre-trigger window is filled with post-trigger samples
+ *  @param  generator
+ *          interrupt generator that triggers the capture, 1 or 2
+ *  @param  timeout_ms
+ *          how long to wait for the trigger
+ *  @param  pre
+ *          optional, set to the number of samples before the trigger
+ *  @return Number of samples captured, 0 on timeout or failure
+ */
+uint16_t Adafruit_LIS3DH::captureShock(lis3dh_sample_t *samples,
+                                       uint16_t maxCount, uint8_t generator,
+                                       uint32_t timeout_ms, uint8_t *pre) {
+  if (pre)
+    *pre = 0;
+  if ((samples == NULL) || (maxCount < LIS3DH_FIFO_SIZE) || (generator < 1) ||
+      (generator > 2))
+    return 0;
+
+  // TR selects the pin whose signal triggers the FIFO, so use the pin the
+  // generator is routed to in CTRL_REG3 / CTRL_REG6
+  uint8_t ia = (generator == 1) ? LIS3DH_INT1_IA1 : LIS3DH_INT1_IA2;
+  uint8_t tr, pin_reg, sources;
+  if (_ctrl[2] & ia) {
+    tr = 0x00;
+    pin_reg = LIS3DH_REG_CTRL3;
+    sources = 0xFE; // everything but the unused bit 0
+  } else if (_ctrl[5] & ia) {
+    tr = 0x20;
+    pin_reg = LIS3DH_REG_CTRL6;
+    sources = 0xF8; // leave the INT_POLARITY bit alone
+  } else {
+    return 0;
+  }
+  uint8_t routed = _ctrl[pin_reg - LIS3DH_REG_CTRL1];
+  uint8_t fifo_saved = _fifoCtrl;
+  uint8_t fifo_en = _ctrl[4] & 0x40; // FIFO_EN
+
+  // restart the FIFO empty with only the generator on the trigger pin, then
+  // stream until the trigger
+  uint16_t count = 0;
+  setFIFOMode(LIS3DH_FIFO_BYPASS);
+  bool armed = updateCtrl(pin_reg, sources, ia) &&
+               updateCtrl(LIS3DH_REG_CTRL5, 0x40, 0x40); // FIFO_EN
+  readInterruptSource(generator); // drop an event latched before arming
+  uint8_t fifo_ctrl = (LIS3DH_FIFO_TRIGGER << 6) | tr | (_fifoCtrl & 0x1F);
+  if (armed && writeRegister(LIS3DH_REG_FIFOCTRL, fifo_ctrl)) {
+    _fifoCtrl = fifo_ctrl;
+    count = captureTriggered(samples, maxCount, generator, timeout_ms, pre);
+  }
+
+  // empty the FIFO, then put the caller's FIFO setup and routing back
+  setFIFOMode(LIS3DH_FIFO_BYPASS);
+  if ((fifo_saved != _fifoCtrl) &&
+      writeRegister(LIS3DH_REG_FIFOCTRL, fifo_saved))
+    _fifoCtrl = fifo_saved;
+  updateCtrl(LIS3DH_REG_CTRL5, 0x40, fifo_en);
+  updateCtrl(pin_reg, sources, routed);
+  return count;
+}
+
+/*!
+ *  @brief  Waits for an armed captureShock() to trigger, then collects the
+ *          pre- and post-trigger samples
+ *  @param  samples
+ *          buffer to fill, at least LIS3DH_FIFO_SIZE
+ *  @param  maxCount
+ *          size of the buffer
+ *  @param  generator
+ *          interrupt generator that triggers the capture, 1 or 2
+ *  @param  timeout_ms
+ *          how long to wait for the trigger
+ *  @param  pre
+ *          optional, set to the number of samples before the trigger
+ *  @return Number of samples captured, 0 on timeout
+ */
+uint16_t Adafruit_LIS3DH::captureTriggered(lis3dh_sample_t *samples,
+                                           uint16_t maxCount,
+                                           uint8_t generator,
+                                           uint32_t timeout_ms,
+                                           uint8_t *pre) {
+  uint32_t start = millis();
+  while (!(readInterruptSource(generator) & 0x40)) { // IA
+    if (millis() - start >= timeout_ms)
+      return 0;
+    delay(1);
+  }
+
+  // the FIFO is now frozen on the samples leading up to the trigger; it is
+  // expected to be full, so read FIFO_SRC here rather than through
+  // getFIFOCount(), which would count that as an overflow
+  uint8_t src = readRegister(LIS3DH_REG_FIFOSRC);
+  uint8_t depth = (src & 0x40) ? LIS3DH_FIFO_SIZE : (src & 0x1F);
+  _haveLastSample = false; // the window doesn't follow on from earlier reads
+  uint16_t count = readFIFO(samples, LIS3DH_FIFO_SIZE, depth, now());
+  if (pre)
+    *pre = count;
+
+  // switching through bypass empties the FIFO for the post-trigger burst
+  uint8_t fifo_ctrl = _fifoCtrl & 0x3F;
+  if (!writeRegister(LIS3DH_REG_FIFOCTRL, fifo_ctrl) ||
+      !writeRegister(LIS3DH_REG_FIFOCTRL,
+                     fifo_ctrl | (LIS3DH_FIFO_STREAM << 6)))
+    return count;
+  _fifoCtrl = fifo_ctrl | (LIS3DH_FIFO_STREAM << 6);
+
+  // allow a couple of sample periods of slack beyond the expected time
+  uint32_t burst_us = (uint32_t)(maxCount - count + 2) * getSamplePeriod();
+  uint32_t burst_start = micros();
+  while ((count < maxCount) && (micros() - burst_start < burst_us)) {
+    uint16_t room = maxCount - count;
+    count += readFIFO(&samples[count],
+                      (room > LIS3DH_FIFO_SIZE) ? LIS3DH_FIFO_SIZE : room);
+  }
+  return count;
+}
+
+/*!
+ *  @brief  Reads and unpacks a run of samples starting at OUT_X_L
+ *
+ *  Samples are timestamped backwards from the newest one in the FIFO, one
+ *  getSamplePeriod() apart. The stretch since the previous run's last
+ *  sample is counted in the gaps stat; the timestamps are only accurate to
+ *  a sample period, so only stretches of two periods or more count.
+ *
+ *  @param  samples
+ *          buffer to fill
+ *  @param  count
+ *          number of samples to read
+ *  @param  newest
+ *          timestamp of the newest sample in the FIFO
+ *  @param  newer
+ *          number of samples in the FIFO that are newer than this run
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::readSampleArray(lis3dh_sample_t *samples, uint8_t count,
+                                      uint32_t newest, uint8_t newer) {
+  if (count == 0)
+    return true;
+
+  // read the raw bytes into the tail of the caller's buffer and unpack them
+  // in place, so draining the FIFO needs no extra RAM
+  uint8_t *buffer =
+      (uint8_t *)samples + count * (sizeof(lis3dh_sample_t) - 6);
+  if (!readSamples(buffer, count))
+    return false;
+  _stats.samples += count;
+
+  uint32_t period = getSamplePeriod();
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t *b = buffer + (i * 6);
+    int16_t sx = b[0] | ((uint16_t)b[1] << 8);
+    int16_t sy = b[2] | ((uint16_t)b[3] << 8);
+    int16_t sz = b[4] | ((uint16_t)b[5] << 8);
+    samples[i].x = sx;
+    samples[i].y = sy;
+    samples[i].z = sz;
+    samples[i].timestamp = newest - (uint32_t)(count - 1 - i + newer) * period;
+  }
+
+  if (_haveLastSample && period) {
+    uint32_t elapsed = samples[0].timestamp - _lastSample;
+    if ((int32_t)elapsed >= (int32_t)(2 * period))
+      _stats.gaps += elapsed / period - 1;
+  }
+  _lastSample = samples[count - 1].timestamp;
+  _haveLastSample = true;
+  return true;
+}
+
+/*!
+ *  @brief  Sets up a ring buffer for interrupt-driven sampling
+ *
+ *  collectSamples() is the single producer and popSample() the single
+ *  consumer, so the two can run in an interrupt handler and loop() without
+ *  locking. One slot is kept free to tell a full buffer from an empty one.
+ *
+ *  @param  buffer
+ *          storage for the ring, owned by the caller
+ *  @param  size
+ *          number of slots in buffer, at least 2
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::setSampleBuffer(lis3dh_sample_t *buffer, uint8_t size) {
+  if ((buffer == NULL) || (size < 2))
+    return false;
+  // collectSamples() may run from an interrupt, so swap buffers atomically
+  noInterrupts();
+  _samples = buffer;
+  lis3dh_ring_reset(&_sampleRing, size);
+  interrupts();
+  return true;
+}
+
+/*!
+ *  @brief  Transfers new data from the sensor into the ring buffer
+ *
+ *  Attach this to the DRDY (see enableDRDY()) or FIFO interrupt on INT1. With
+ *  the FIFO enabled every pending sample is drained, otherwise the current
+ *  output registers are read. On cores whose Wire/SPI drivers cannot be used
+ *  from an interrupt, call it from a task or loop() woken by the interrupt.
+ *
+ *  @return Number of samples added; samples that do not fit are left behind
+ */
+uint8_t Adafruit_LIS3DH::collectSamples(void) {
+  uint8_t size = _sampleRing.size;
+  if (size == 0)
+    return 0;
+
+  uint8_t head = _sampleRing.head;
+  uint8_t space = lis3dh_ring_free(&_sampleRing);
+
+  uint8_t depth = 1;
+  if (_ctrl[4] & 0x40) // FIFO_EN
+    depth = getFIFOCount();
+  uint32_t drained = now();
+  uint8_t count = (depth > space) ? space : depth;
+  if (!(_ctrl[4] & 0x40)) // without the FIFO, what doesn't fit is lost
+    _stats.dropped += depth - count;
+  if (count == 0)
+    return 0;
+
+  // the free space may wrap around the end of the ring
+  uint8_t first = size - head;
+  if (first > count)
+    first = count;
+  if (!readSampleArray(&_samples[head], first, drained, depth - first) ||
+      !readSampleArray(&_samples[0], count - first, drained, depth - count))
+    return 0;
+  lis3dh_ring_publish(&_sampleRing, count);
+  return count;
+}
+
+/*!
+ *  @brief  Gets the number of samples waiting in the ring buffer
+ *  @return Number of samples
+ */
+uint8_t Adafruit_LIS3DH::samplesAvailable(void) {
+  return lis3dh_ring_used(&_sampleRing);
+}
+
+/*!
+ *  @brief  Takes the oldest sample from the ring buffer
+ *  @param  sample
+ *          sample to fill
+ *  @return true if a sample was available
+ */
+bool Adafruit_LIS3DH::popSample(lis3dh_sample_t *sample) {
+  if (lis3dh_ring_used(&_sampleRing) == 0)
+    return false;
+  *sample = _samples[_sampleRing.tail];
+  lis3dh_ring_release(&_sampleRing);
+  return true;
+}
+
+/*!
+ *  @brief  Burst reads raw samples starting at OUT_X_L
+ *  @param  buffer
+ *          destination for count * 6 bytes
+ *  @param  count
+ *          number of x/y/z samples to read
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::readSamples(uint8_t *buffer, uint8_t count) {
+  // restart each burst on a sample boundary so the register pointer stays
+  // in step
+  uint8_t per_burst = _burstSamples;
+  while (count) {
+    uint8_t n = (count > per_burst) ? per_burst : count;
+    if (!readRegisters(LIS3DH_REG_OUT_X_L, buffer, n * 6))
+      return false;
+    buffer += n * 6;
+    count -= n;
+  }
+  return true;
+}
+
+/*!
+ *  @brief  Reads consecutive registers in one auto-increment transaction
+ *  @param  reg
+ *          first register address
+ *  @param  buffer
+ *          destination for len bytes
+ *  @param  len
+ *          number of bytes to read
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::readRegisters(uint8_t reg, uint8_t *buffer,
+                                    uint8_t len) {
+  uint8_t address = reg | _readFlags;
+
+  // talk to the bus device directly rather than through a temporary
+  // Adafruit_BusIO_Register, which costs stack and cycles on every call
+  LIS3DH_BUS_BEGIN(reg, len, false);
+  bool ok = false;
+  if (i2c_dev)
+    ok = i2c_dev->write_then_read(&address, 1, buffer, len);
+  else if (spi_dev)
+    ok = spi_dev->write_then_read(&address, 1, buffer, len);
+  LIS3DH_BUS_END(reg, len, false);
+
+  if (!ok)
+    _stats.busErrors++;
+  return ok;
+}
+
+/*!
+ *  @brief  Writes consecutive registers in one auto-increment transaction
+ *  @param  reg
+ *          first register address
+ *  @param  buffer
+ *          len bytes to write
+ *  @param  len
+ *          number of bytes to write
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::writeRegisters(uint8_t reg, const uint8_t *buffer,
+                                     uint8_t len) {
+  uint8_t address = reg | _writeFlags;
+
+  // the address goes out as a prefix, so buffer needn't be copied
+  LIS3DH_BUS_BEGIN(reg, len, true);
+  bool ok = false;
+  if (i2c_dev)
+    ok = i2c_dev->write(buffer, len, true, &address, 1);
+  else if (spi_dev)
+    ok = spi_dev->write(buffer, len, &address, 1);
+  LIS3DH_BUS_END(reg, len, true);
+
+  if (!ok)
+    _stats.busErrors++;
+  return ok;
+}
+
+/*!
+ *  @brief  Reads a single register
+ *  @param  reg
+ *          register address
+ *  @return register value
+ */
+uint8_t Adafruit_LIS3DH::readRegister(uint8_t reg) {
+  uint8_t value = 0;
+  readRegisters(reg, &value, 1);
+  return value;
+}
+
+/*!
+ *  @brief  Writes a single register
+ *  @param  reg
+ *          register address
+ *  @param  value
+ *          value to write
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::writeRegister(uint8_t reg, uint8_t value) {
+  return writeRegisters(reg, &value, 1);
+}
+
+/*!
+ *  @brief  Updates bits of a CTRL_REGx register and its cached copy, skipping
+ *          the bus write when nothing changes
+ *  @param  reg
+ *          register address, LIS3DH_REG_CTRL1 to LIS3DH_REG_CTRL6
+ *  @param  mask
+ *          bits to change
+ *  @param  value
+ *          new value for the masked bits
+ *  @return true if successful
+ */
+bool Adafruit_LIS3DH::updateCtrl(uint8_t reg, uint8_t mask, uint8_t value) {
+  uint8_t *cached = &_ctrl[reg - LIS3DH_REG_CTRL1];
+  uint8_t updated = (*cached & ~mask) | (value & mask);
+  if (updated == *cached)
+    return true;
+
+  if (!writeRegister(reg, updated))
+    return false;
+  *cached = updated;
+  if ((reg == LIS3DH_REG_CTRL1) || (reg == LIS3DH_REG_CTRL4))
+    updateScale();
+  return true;
+}
+
+/*!
+ *  @brief  Updates bits of TEMP_CFG_REG and its cached copy
+ *  @param  mask
+ *          bits to change
+ *  @param  value
+ *          new value for the masked bits
+ */
+void Adafruit_LIS3DH::updateTempCfg(uint8_t mask, uint8_t value) {
+  uint8_t updated = (_tempCfg & ~mask) | (value & mask);
+  if ((updated != _tempCfg) && writeRegister(LIS3DH_REG_TEMPCFG, updated))
+    _tempCfg = updated;
+}
+
+/*!
+ *  @brief  Picks the raw to g multiplier for the cached range and mode
+ */
+void Adafruit_LIS3DH::updateScale(void) {
+  _scale = getScale(getRange(), getPerformanceMode());
+}
+
+/*!
+ *  @brief  Gets the multiplier from raw 16-bit readings to acceleration
+ *  @param  range
+ *          range the readings were taken at
+ *  @param  mode
+ *          performance mode the readings were taken in
+ *  @param  ms2
+ *          true for m/s^2, false for g
+ *  @return Acceleration per LSB, for use with convert()
+ */
+float Adafruit_LIS3DH::getScale(lis3dh_range_t range, lis3dh_mode_t mode,
+                                bool ms2) {
+  float scale = lis3dh_g_per_lsb[range & 0x03][mode % 3];
+  return ms2 ? scale * SENSORS_GRAVITY_STANDARD : scale;
+}
+
+/*!
+ *  @brief  Converts a block of raw readings to g or m/s^2
+ *
+ *  Every value is scaled the same way, so x/y/z interleaved arrays (count =
+ *  3 * samples) and planar arrays (one call per axis, or count = 3 * samples
+ *  for back to back planes) are both handled. This is the conversion used by
+ *  read(), getEvent() and getEvents(), and it needs no sensor, so logged raw
+ *  data can be post-processed with it too.
+ *
+ *  @param  raw
+ *          raw left-justified readings, e.g. x, y, z or lis3dh_sample_t
+ *          fields
+ *  @param  out
+ *          destination for count values, must not overlap raw
+ *  @param  count
+ *          number of values to convert
+ *  @param  scale
+ *          multiplier from getScale()
+ */
+void Adafruit_LIS3DH::convert(const int16_t *__restrict raw,
+                              float *__restrict out, size_t count,
+                              float scale) {
+  // a plain loop over non-aliased arrays, which the compiler vectorises on
+  // targets with SIMD and which is the scalar fallback everywhere else
+  for (size_t i = 0; i < count; i++)
+    out[i] = raw[i] * scale;
+}
+
+/*!
+ *  @brief  Converts a block of raw readings to milli-g using integer math
+ *          only, laid out as for convert()
+ *  @param  raw
+ *          raw left-justified readings
+ *  @param  out
+ *          destination for count values in milli-g, must not overlap raw
+ *  @param  count
+ *          number of values to convert
+ *  @param  range
+ *          range the readings were taken at
+ *  @param  mode
+ *          performance mode the readings were taken in
+ */
+void Adafruit_LIS3DH::convertMilliG(const int16_t *__restrict raw,
+                                    int32_t *__restrict out, size_t count,
+                                    lis3dh_range_t range,
+                                    lis3dh_mode_t mode) {
+  int32_t mg16 = lis3dh_mg16_per_lsb[range & 0x03][mode % 3];
+  for (size_t i = 0; i < count; i++)
+    out[i] = (raw[i] * mg16) / 16;
 }
 
 /*!
@@ -522,17 +1665,123 @@ bool Adafruit_LIS3DH::getEvent(sensors_event_t *event) {
   event->version = sizeof(sensors_event_t);
   event->sensor_id = _sensorID;
   event->type = SENSOR_TYPE_ACCELEROMETER;
-  event->timestamp = 0;
+  event->timestamp = millis();
 
   read();
 
-  event->acceleration.x = x_g * SENSORS_GRAVITY_STANDARD;
-  event->acceleration.y = y_g * SENSORS_GRAVITY_STANDARD;
-  event->acceleration.z = z_g * SENSORS_GRAVITY_STANDARD;
+  int16_t raw[3] = {x, y, z};
+  convert(raw, event->acceleration.v, 3, _scale * SENSORS_GRAVITY_STANDARD);
 
   return true;
 }
 
+/*!
+ *  @brief  Configures the on-chip high pass filter
+ *
+ *  The cutoff depends on the data rate, see the datasheet's "High pass
+ *  filter cutoff frequency configuration" table; 0 is the highest cutoff.
+ *
+ *  @param  mode
+ *          filter mode, e.g. LIS3DH_HPF_NORMAL
+ *  @param  cutoff
+ *          cutoff selection (HPCF2-HPCF1), 0 to 3
+ *  @param  targets
+ *          what the filter applies to, LIS3DH_HPF_* bits or 0 to bypass it
+ */
+void Adafruit_LIS3DH::setHighPassFilter(lis3dh_hpf_mode_t mode, uint8_t cutoff,
+                                        uint8_t targets) {
+  updateCtrl(LIS3DH_REG_CTRL2, 0xFF,
+             (mode << 6) | ((cutoff & 0x03) << 4) | (targets & 0x0F));
+}
+
+/*!
+ *  @brief  Resets the high pass filter to the current acceleration, by
+ *          reading REFERENCE. Only has an effect in LIS3DH_HPF_NORMAL_RESET
+ */
+void Adafruit_LIS3DH::resetHighPassFilter(void) {
+  readRegister(LIS3DH_REG_REFERENCE);
+}
+
+/*!
+ *  @brief  Sets the REFERENCE value subtracted from the acceleration in
+ *          LIS3DH_HPF_REFERENCE mode
+ *  @param  reference
+ *          reference value, in the same units as the interrupt thresholds
+ */
+void Adafruit_LIS3DH::setReference(uint8_t reference) {
+  writeRegister(LIS3DH_REG_REFERENCE, reference);
+}
+
+/*!
+ *  @brief  Gets the data loss and bus health counters, to check whether the
+ *          sensor is being read fast enough for its data rate
+ *  @param  stats
+ *          counters to fill
+ */
+void Adafruit_LIS3DH::getStats(lis3dh_stats_t *stats) { *stats = _stats; }
+
+/*!
+ *  @brief  Resets the data loss and bus health counters. Gap counting
+ *          restarts from the next read, so call this after pausing on purpose
+ */
+void Adafruit_LIS3DH::resetStats(void) {
+  memset(&_stats, 0, sizeof(_stats));
+  _haveLastSample = false; // don't count the time since the last read
+}
+
+/*!
+ *  @brief  Gets a batch of sensor events from the FIFO in one burst
+ *
+ *  With the FIFO enabled up to n pending samples are drained, oldest first,
+ *  otherwise a single event is read from the output registers.
+ *
+ *  @param  *events
+ *          array of events to fill
+ *  @param  n
+ *          number of events the array can hold
+ *  @return Number of events filled
+ */
+size_t Adafruit_LIS3DH::getEvents(sensors_event_t *events, size_t n) {
+  uint8_t depth = 1;
+  if (_ctrl[4] & 0x40) // FIFO_EN
+    depth = getFIFOCount();
+  uint32_t drained = now();
+  uint32_t drained_ms = millis();
+  uint8_t count = (depth > n) ? n : depth;
+  if (count == 0)
+    return 0;
+
+  // the raw samples are unpacked into the tail of the event array and
+  // converted front to back; an event is larger than a sample, so each one
+  // only overwrites samples that have already been converted
+  static_assert(sizeof(sensors_event_t) >= sizeof(lis3dh_sample_t),
+                "events must be at least as large as samples");
+  lis3dh_sample_t *samples =
+      (lis3dh_sample_t *)((uint8_t *)(events + count) -
+                          count * sizeof(lis3dh_sample_t));
+  if (!readSampleArray(samples, count, drained, depth - count))
+    return 0;
+
+  sensors_event_t proto;
+  memset(&proto, 0, sizeof(sensors_event_t));
+  proto.version = sizeof(sensors_event_t);
+  proto.sensor_id = _sensorID;
+  proto.type = SENSOR_TYPE_ACCELEROMETER;
+
+  float scale = _scale * SENSORS_GRAVITY_STANDARD;
+  for (uint8_t i = 0; i < count; i++) {
+    lis3dh_sample_t sample;
+    memcpy(&sample, &samples[i], sizeof(lis3dh_sample_t));
+    int16_t raw[3] = {sample.x, sample.y, sample.z};
+
+    events[i] = proto;
+    // event timestamps are millis(), offset by the sample's age
+    events[i].timestamp = drained_ms - (drained - sample.timestamp) / 1000;
+    convert(raw, events[i].acceleration.v, 3, scale);
+  }
+  return count;
+}
+
 /*!
  *   @brief  Gets the sensor_t data
  *   @param  *sensor
@@ -553,3 +1802,87 @@ void Adafruit_LIS3DH::getSensor(sensor_t *sensor) {
   sensor->min_value = 0;
   sensor->resolution = 0;
 }
+
+#ifdef LIS3DH_BUS_HOOKS
+
+static lis3dh_bus_timing_t lis3dh_bus_timings[LIS3DH_BUS_TIMING_SLOTS];
+static uint8_t lis3dh_bus_timing_slots = 0;
+static uint32_t lis3dh_bus_start;
+
+/*!
+ *  @brief  Default hook called before each register access, replace it by
+ *          defining your own
+ *  @param  reg
+ *          first register address
+ *  @param  len
+ *          number of bytes
+ *  @param  write
+ *          true for a write, false for a read
+ */
+__attribute__((weak)) void lis3dh_busHookBegin(uint8_t reg, uint8_t len,
+                                               bool write) {
+  (void)reg;
+  (void)len;
+  (void)write;
+  lis3dh_bus_start = micros();
+}
+
+/*!
+ *  @brief  Default hook called after each register access, records its
+ *          latency against the register. Replace it by defining your own
+ *  @param  reg
+ *          first register address
+ *  @param  len
+ *          number of bytes
+ *  @param  write
+ *          true for a write, false for a read
+ */
+__attribute__((weak)) void lis3dh_busHookEnd(uint8_t reg, uint8_t len,
+                                             bool write) {
+  (void)write;
+  uint32_t elapsed = micros() - lis3dh_bus_start;
+
+  lis3dh_bus_timing_t *slot = NULL;
+  for (uint8_t i = 0; i < lis3dh_bus_timing_slots; i++) {
+    if (lis3dh_bus_timings[i].reg == reg) {
+      slot = &lis3dh_bus_timings[i];
+      break;
+    }
+  }
+  if (slot == NULL) {
+    if (lis3dh_bus_timing_slots == LIS3DH_BUS_TIMING_SLOTS)
+      return; // table full, ignore this register
+    slot = &lis3dh_bus_timings[lis3dh_bus_timing_slots++];
+    slot->reg = reg;
+    slot->min_us = elapsed;
+  }
+
+  slot->count++;
+  slot->bytes += len;
+  slot->sum_us += elapsed;
+  if (elapsed < slot->min_us)
+    slot->min_us = elapsed;
+  if (elapsed > slot->max_us)
+    slot->max_us = elapsed;
+}
+
+/*!
+ *  @brief  Gets the latency table kept by the default bus hooks
+ *  @param  slots
+ *          set to the number of registers in the table
+ *  @return Pointer to the table
+ */
+const lis3dh_bus_timing_t *lis3dh_getBusTimings(uint8_t *slots) {
+  *slots = lis3dh_bus_timing_slots;
+  return lis3dh_bus_timings;
+}
+
+/*!
+ *  @brief  Clears the latency table kept by the default bus hooks
+ */
+void lis3dh_resetBusTimings(void) {
+  memset(lis3dh_bus_timings, 0, sizeof(lis3dh_bus_timings));
+  lis3dh_bus_timing_slots = 0;
+}
+
+#endif
@@ -36,6 +36,7 @@
 #include <Adafruit_I2CDevice.h>
 #include <Adafruit_SPIDevice.h>
 #include <Adafruit_Sensor.h>
+#include <new>
 
 /** I2C ADDRESS/BITS **/
 #define LIS3DH_DEFAULT_ADDRESS (0x18) // if SDO/SA0 is 3V, its 0x19
@@ -245,6 +246,10 @@
   0x32 /**< INT1_THS register [0, THS6, THS5, THS4, THS3, THS1, THS0] */
 #define LIS3DH_REG_INT1DUR                                                     \
   0x33 /**< INT1_DURATION [0, D6, D5, D4, D3, D2, D1, D0] */
+#define LIS3DH_REG_INT2CFG 0x34 /**< INT2_CFG, same layout as INT1_CFG */
+#define LIS3DH_REG_INT2SRC 0x35 /**< INT2_SRC, same layout as INT1_SRC */
+#define LIS3DH_REG_INT2THS 0x36 /**< INT2_THS, same layout as INT1_THS */
+#define LIS3DH_REG_INT2DUR 0x37 /**< INT2_DURATION, same as INT1_DURATION */
 /*!
  *  CLICK_CFG
  *   [--, --, ZD, ZS, YD, YS, XD, XS]
@@ -321,6 +326,44 @@
 
 #define LIS3DH_DEFAULT_SPIFREQ 500000 ///< SPI frequency for LIS3DH
 
+/** Register address bits for burst transfers **/
+#define LIS3DH_I2C_AUTOINC 0x80 ///< I2C sub-address bit 7, auto-increment
+#define LIS3DH_SPI_READ 0x80    ///< SPI address bit 7, read
+#define LIS3DH_SPI_AUTOINC 0x40 ///< SPI address bit 6, auto-increment
+
+#define LIS3DH_FIFO_SIZE 32 ///< Number of x/y/z samples the FIFO can hold
+
+/** CTRL_REG3 bits, routing interrupts to INT1 **/
+#define LIS3DH_INT1_CLICK 0x80   ///< CLICK interrupt on INT1
+#define LIS3DH_INT1_IA1 0x40     ///< Interrupt generator 1 on INT1
+#define LIS3DH_INT1_IA2 0x20     ///< Interrupt generator 2 on INT1
+#define LIS3DH_INT1_DRDY1 0x10   ///< ZYXDA data ready on INT1
+#define LIS3DH_INT1_DRDY2 0x08   ///< 321DA data ready on INT1
+#define LIS3DH_INT1_WTM 0x04     ///< FIFO watermark on INT1
+#define LIS3DH_INT1_OVERRUN 0x02 ///< FIFO overrun on INT1
+
+/** CTRL_REG6 bits, routing interrupts to INT2 **/
+#define LIS3DH_INT2_CLICK 0x80     ///< CLICK interrupt on INT2
+#define LIS3DH_INT2_IA1 0x40       ///< Interrupt generator 1 on INT2
+#define LIS3DH_INT2_IA2 0x20       ///< Interrupt generator 2 on INT2
+#define LIS3DH_INT2_BOOT 0x10      ///< Boot status on INT2
+#define LIS3DH_INT2_ACT 0x08       ///< Activity interrupt on INT2
+#define LIS3DH_INT_ACTIVE_LOW 0x02 ///< INT1 and INT2 are active low
+
+/** INTx_CFG bits, selecting the events an interrupt generator reacts to **/
+#define LIS3DH_INT_XLOW 0x01  ///< X low event, or X down in 6D mode
+#define LIS3DH_INT_XHIGH 0x02 ///< X high event, or X up in 6D mode
+#define LIS3DH_INT_YLOW 0x04  ///< Y low event, or Y down in 6D mode
+#define LIS3DH_INT_YHIGH 0x08 ///< Y high event, or Y up in 6D mode
+#define LIS3DH_INT_ZLOW 0x10  ///< Z low event, or Z down in 6D mode
+#define LIS3DH_INT_ZHIGH 0x20 ///< Z high event, or Z up in 6D mode
+
+/** CTRL_REG2 bits, selecting what the high pass filter applies to **/
+#define LIS3DH_HPF_OUTPUT 0x08 ///< Output registers and FIFO (FDS)
+#define LIS3DH_HPF_CLICK 0x04  ///< Click detection (HPCLICK)
+#define LIS3DH_HPF_IA2 0x02    ///< Interrupt generator 2 (HP_IA2)
+#define LIS3DH_HPF_IA1 0x01    ///< Interrupt generator 1 (HP_IA1)
+
 /** A structure to represent scales **/
 typedef enum {
   LIS3DH_RANGE_16_G = 0b11, // +/- 16g
@@ -361,6 +404,131 @@ typedef enum {
 
 } lis3dh_dataRate_t;
 
+/*!
+ * @brief  Interrupt generator mode
+ * Used with registers 0x30/0x34 (LIS3DH_REG_INT1CFG/INT2CFG) AOI and 6D bits
+ */
+typedef enum {
+  LIS3DH_INT_OR = 0x00,          // any enabled event, e.g. wake-up
+  LIS3DH_INT_6D_MOVEMENT = 0x40, // orientation changes
+  LIS3DH_INT_AND = 0x80,         // all enabled events, e.g. free-fall
+  LIS3DH_INT_6D_POSITION = 0xC0, // device in a known orientation
+} lis3dh_int_mode_t;
+
+/*!
+ * @brief  High pass filter mode selection
+ * Used with register 0x21 (LIS3DH_REG_CTRL2) HPM1-HPM0 bits
+ */
+typedef enum {
+  LIS3DH_HPF_NORMAL_RESET = 0b00, // normal, reset by reading REFERENCE
+  LIS3DH_HPF_REFERENCE = 0b01,    // output is relative to REFERENCE
+  LIS3DH_HPF_NORMAL = 0b10,       // normal mode
+  LIS3DH_HPF_AUTORESET = 0b11,    // reset on interrupt event
+} lis3dh_hpf_mode_t;
+
+/*!
+ * @brief  FIFO mode selection
+ * Used with register 0x2E (LIS3DH_REG_FIFOCTRL) FM1-FM0 bits
+ */
+typedef enum {
+  LIS3DH_FIFO_BYPASS = 0b00,  // FIFO disabled, output registers only
+  LIS3DH_FIFO_FIFO = 0b01,    // fill the FIFO then stop collecting
+  LIS3DH_FIFO_STREAM = 0b10,  // keep the newest 32 samples
+  LIS3DH_FIFO_TRIGGER = 0b11, // stream until trigger, then FIFO
+} lis3dh_fifo_mode_t;
+
+/** A single raw x/y/z sample, as read from the output registers / FIFO **/
+typedef struct {
+  int16_t x;          /**< x axis value */
+  int16_t y;          /**< y axis value */
+  int16_t z;          /**< z axis value */
+  uint32_t timestamp; /**< when the sample was taken, in microseconds */
+} lis3dh_sample_t;
+
+/** Indices of a single producer, single consumer ring in caller storage **/
+typedef struct {
+  volatile uint8_t size; /**< number of slots, 0 until a buffer is set */
+  volatile uint8_t head; /**< next slot the producer fills */
+  volatile uint8_t tail; /**< next slot the consumer takes */
+} lis3dh_ring_t;
+
+/** A decoded tap, queued by collectTap() **/
+typedef struct {
+  uint8_t axes;       /**< axes that detected the tap: 1 = X, 2 = Y, 4 = Z */
+  bool negative;      /**< tap was in the negative direction */
+  bool doubleTap;     /**< double tap rather than single tap */
+  uint32_t timestamp; /**< when the tap was collected, in microseconds */
+} lis3dh_tap_t;
+
+/*!
+ *  @brief  Sensor configuration, read with getConfig() and written in bulk
+ *          with applyConfig()
+ */
+typedef struct {
+  lis3dh_dataRate_t dataRate;  /**< output data rate */
+  lis3dh_range_t range;        /**< full scale range */
+  lis3dh_mode_t mode;          /**< performance mode */
+  bool blockDataUpdate;        /**< hold outputs until both bytes are read */
+  uint8_t int1;                /**< LIS3DH_INT1_* bits (CTRL_REG3) */
+  uint8_t int2;                /**< LIS3DH_INT2_* bits (CTRL_REG6) */
+  bool latchInt1;              /**< latch INT1 until INT1_SRC is read */
+  lis3dh_fifo_mode_t fifoMode; /**< FIFO mode */
+  uint8_t fifoWatermark;       /**< FIFO watermark level, 0 to 31 */
+  uint8_t clickConfig;         /**< CLICK_CFG tap enables per axis */
+  uint8_t clickThreshold;      /**< CLICK_THS threshold */
+  uint8_t clickTimeLimit;      /**< TIME_LIMIT */
+  uint8_t clickTimeLatency;    /**< TIME_LATENCY */
+  uint8_t clickTimeWindow;     /**< TIME_WINDOW */
+} lis3dh_config_t;
+
+/** Data loss and bus health counters, see getStats() **/
+typedef struct {
+  uint32_t samples;       /**< samples read from the sensor */
+  uint32_t overruns;      /**< ZYXOR overruns seen by read() / readIfNew() */
+  uint32_t fifoOverflows; /**< FIFO depth checks that found OVRN_FIFO set */
+  uint32_t dropped;       /**< samples lost to a full ring buffer */
+  uint32_t gaps;          /**< samples missed between reads, from timestamps */
+  uint32_t busErrors;     /**< failed bus transactions */
+  uint8_t maxFIFOLevel;   /**< deepest FIFO fill level seen */
+} lis3dh_stats_t;
+
+/** Clock used to timestamp samples, returning microseconds **/
+typedef uint32_t (*lis3dh_clock_t)(void);
+
+/*!
+ *  Bus transaction hooks. Define LIS3DH_BUS_HOOKS for the whole build (e.g.
+ *  -DLIS3DH_BUS_HOOKS) to have lis3dh_busHookBegin() and lis3dh_busHookEnd()
+ *  called around every register access. The default hooks keep a small
+ *  per-register latency table, see lis3dh_getBusTimings(), and can be
+ *  replaced by defining your own. Without LIS3DH_BUS_HOOKS they compile to
+ *  nothing.
+ */
+#ifdef LIS3DH_BUS_HOOKS
+
+#define LIS3DH_BUS_TIMING_SLOTS 16 ///< Registers tracked by the default hooks
+
+/** Latency of the transactions to one register, see lis3dh_getBusTimings() **/
+typedef struct {
+  uint8_t reg;     /**< first register of the transactions */
+  uint32_t count;  /**< number of transactions */
+  uint32_t bytes;  /**< data bytes transferred */
+  uint32_t min_us; /**< shortest transaction */
+  uint32_t max_us; /**< longest transaction */
+  uint32_t sum_us; /**< total time, sum_us / count gives the mean */
+} lis3dh_bus_timing_t;
+
+void lis3dh_busHookBegin(uint8_t reg, uint8_t len, bool write);
+void lis3dh_busHookEnd(uint8_t reg, uint8_t len, bool write);
+const lis3dh_bus_timing_t *lis3dh_getBusTimings(uint8_t *slots);
+void lis3dh_resetBusTimings(void);
+
+#define LIS3DH_BUS_BEGIN(reg, len, write) lis3dh_busHookBegin(reg, len, write)
+#define LIS3DH_BUS_END(reg, len, write) lis3dh_busHookEnd(reg, len, write)
+#else
+#define LIS3DH_BUS_BEGIN(reg, len, write) ///< No-op without LIS3DH_BUS_HOOKS
+#define LIS3DH_BUS_END(reg, len, write)   ///< No-op without LIS3DH_BUS_HOOKS
+#endif
+
 /*!
  *  @brief  Class that stores state and functions for interacting with
  *          Adafruit_LIS3DH
@@ -372,15 +540,28 @@ public:
                   uint32_t frequency = LIS3DH_DEFAULT_SPIFREQ);
   Adafruit_LIS3DH(int8_t cspin, int8_t mosipin, int8_t misopin, int8_t sckpin,
                   uint32_t frequency = LIS3DH_DEFAULT_SPIFREQ);
+  Adafruit_LIS3DH(const Adafruit_LIS3DH &other);
+  Adafruit_LIS3DH &operator=(const Adafruit_LIS3DH &other) = delete;
+  ~Adafruit_LIS3DH(void);
 
   bool begin(uint8_t addr = LIS3DH_DEFAULT_ADDRESS, uint8_t nWAI = 0x33);
 
   uint8_t getDeviceID(void);
+  bool syncConfig(void);
+  void getConfig(lis3dh_config_t *config);
+  bool applyConfig(const lis3dh_config_t *config);
   bool haveNewData(void);
   bool enableDRDY(bool enable_drdy = true, uint8_t int_pin = 1);
 
   void read(void);
+  bool readIfNew(bool *overrun = NULL);
+  bool readMilliG(int32_t *x_mg, int32_t *y_mg, int32_t *z_mg);
   int16_t readADC(uint8_t a);
+  bool readADCs(int16_t *adc1, int16_t *adc2, int16_t *adc3);
+  void enableADC(bool enable_adc = true);
+  void enableTemperature(bool enable_temp = true);
+  float readTemperature(void);
+  void setTemperatureOffset(float offset);
 
   lis3dh_mode_t getPerformanceMode(void);
   void setPerformanceMode(lis3dh_mode_t mode);
@@ -390,16 +571,69 @@ public:
 
   void setDataRate(lis3dh_dataRate_t dataRate);
   lis3dh_dataRate_t getDataRate(void);
+  uint32_t getSamplePeriod(void);
+
+  void setClockSource(lis3dh_clock_t clock);
+  uint32_t now(void);
+
+  void setFIFOMode(lis3dh_fifo_mode_t mode);
+  lis3dh_fifo_mode_t getFIFOMode(void);
+  uint8_t getFIFOCount(void);
+  uint8_t readFIFO(lis3dh_sample_t *samples,
+                   uint8_t maxCount = LIS3DH_FIFO_SIZE);
+  uint8_t readFIFO(lis3dh_sample_t *samples, uint8_t maxCount, uint8_t depth,
+                   uint32_t counted);
+  void setFIFOWatermark(uint8_t level);
+  uint8_t getFIFOWatermark(void);
+  bool enableFIFOInterrupts(bool watermark, bool overrun = false,
+                            uint8_t int_pin = 1);
+  uint8_t readFIFOWatermark(lis3dh_sample_t *samples);
+  uint16_t captureShock(lis3dh_sample_t *samples, uint16_t maxCount,
+                        uint8_t generator = 1, uint32_t timeout_ms = 10000,
+                        uint8_t *pre = NULL);
+
+  bool setSampleBuffer(lis3dh_sample_t *buffer, uint8_t size);
+  uint8_t collectSamples(void);
+  uint8_t samplesAvailable(void);
+  bool popSample(lis3dh_sample_t *sample);
+
+  void getStats(lis3dh_stats_t *stats);
+  void resetStats(void);
+
+  void setHighPassFilter(lis3dh_hpf_mode_t mode, uint8_t cutoff,
+                         uint8_t targets);
+  void resetHighPassFilter(void);
+  void setReference(uint8_t reference);
+
+  static float getScale(lis3dh_range_t range, lis3dh_mode_t mode,
+                        bool ms2 = false);
+  static void convert(const int16_t *raw, float *out, size_t count,
+                      float scale);
+  static void convertMilliG(const int16_t *raw, int32_t *out, size_t count,
+                            lis3dh_range_t range, lis3dh_mode_t mode);
 
   bool getEvent(sensors_event_t *event);
+  size_t getEvents(sensors_event_t *events, size_t n);
   void getSensor(sensor_t *sensor);
 
   void setClick(uint8_t c, uint8_t clickthresh, uint8_t timelimit = 10,
                 uint8_t timelatency = 20, uint8_t timewindow = 255);
   uint8_t getClick(void);
+  void setTap(uint8_t c, uint16_t threshold_mg, uint16_t timelimit_ms = 25,
+              uint16_t timelatency_ms = 50, uint16_t timewindow_ms = 600);
+  bool setTapBuffer(lis3dh_tap_t *buffer, uint8_t size);
+  bool collectTap(void);
+  uint8_t tapsAvailable(void);
+  bool popTap(lis3dh_tap_t *tap);
 
   uint8_t readAndClearInterrupt(void);
 
+  bool setInterruptGenerator(uint8_t generator, lis3dh_int_mode_t mode,
+                             uint8_t events, uint16_t threshold_mg,
+                             uint8_t duration, uint8_t int_pin = 1,
+                             bool latch = true);
+  uint8_t readInterruptSource(uint8_t generator);
+
   int16_t x; /**< x axis value */
   int16_t y; /**< y axis value */
   int16_t z; /**< z axis value */
@@ -409,20 +643,63 @@ public:
   float z_g; /**< z_g axis value (calculated by selected range) */
 
 private:
-  TwoWire *I2Cinterface;
-  SPIClass *SPIinterface;
+  bool readRegisters(uint8_t reg, uint8_t *buffer, uint8_t len);
+  void unpackXYZ(const uint8_t *buffer);
+  void scaleXYZ(void);
+  bool writeRegisters(uint8_t reg, const uint8_t *buffer, uint8_t len);
+  uint8_t readRegister(uint8_t reg);
+  bool writeRegister(uint8_t reg, uint8_t value);
+  bool readSamples(uint8_t *buffer, uint8_t count);
+  bool readSampleArray(lis3dh_sample_t *samples, uint8_t count,
+                       uint32_t newest, uint8_t newer);
+  bool updateCtrl(uint8_t reg, uint8_t mask, uint8_t value);
+  void updateScale(void);
+  void updateTempCfg(uint8_t mask, uint8_t value);
+  void releaseBus(void);
+  uint16_t captureTriggered(lis3dh_sample_t *samples, uint16_t maxCount,
+                            uint8_t generator, uint32_t timeout_ms,
+                            uint8_t *pre);
+
+  TwoWire *I2Cinterface = NULL;
+  SPIClass *SPIinterface = NULL;
 
   Adafruit_I2CDevice *i2c_dev = NULL; ///< Pointer to I2C bus interface
   Adafruit_SPIDevice *spi_dev = NULL; ///< Pointer to SPI bus interface
+  /// Storage for whichever bus device begin() constructs, so none is on the
+  /// heap. i2c_dev / spi_dev point in here, so copies start without a device.
+  alignas(Adafruit_I2CDevice) alignas(Adafruit_SPIDevice) uint8_t
+      _busStorage[sizeof(Adafruit_I2CDevice) > sizeof(Adafruit_SPIDevice)
+                      ? sizeof(Adafruit_I2CDevice)
+                      : sizeof(Adafruit_SPIDevice)];
 
   uint8_t _wai;
+  uint8_t _readFlags = 0;    ///< Address bits for a burst read on this bus
+  uint8_t _writeFlags = 0;   ///< Address bits for a burst write on this bus
+  uint8_t _burstSamples = 1; ///< Samples per readSamples() transaction
 
   int8_t _cs, _mosi, _miso, _sck;
 
   int8_t _i2caddr;
 
   int32_t _sensorID;
+  uint8_t _ctrl[6] = {0}; ///< Cached copy of CTRL_REG1 - CTRL_REG6
+  float _scale = 0;       ///< g per LSB for the cached range and mode
+  uint8_t _fifoCtrl = 0;  ///< Cached copy of FIFO_CTRL_REG
+  uint8_t _tempCfg = 0;   ///< Cached copy of TEMP_CFG_REG
+  float _tempOffset = 25; ///< Temperature when the sensor reads 0
+  uint8_t _clickCfg = 0;  ///< Cached copy of CLICK_CFG
+
+  uint8_t _clickTiming[4] = {0}; ///< Cached CLICK_THS - TIME_WINDOW
   uint32_t _frequency = LIS3DH_DEFAULT_SPIFREQ;
+  lis3dh_clock_t _clock = NULL; ///< Timestamp source, micros() if NULL
+  lis3dh_stats_t _stats = {};   ///< Data loss and bus health counters
+  uint32_t _lastSample = 0;     ///< Timestamp of the last sample read
+  bool _haveLastSample = false; ///< _lastSample is set, for gap counting
+
+  lis3dh_sample_t *_samples = NULL;      ///< Caller-provided sample ring
+  lis3dh_ring_t _sampleRing = {0, 0, 0}; ///< collectSamples() -> popSample()
+  lis3dh_tap_t *_taps = NULL;            ///< Caller-provided tap queue
+  lis3dh_ring_t _tapRing = {0, 0, 0};    ///< collectTap() -> popTap()
 };
 
 #endif
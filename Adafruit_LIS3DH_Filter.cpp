@@ -0,0 +1,183 @@
+/*!
+ * @file Adafruit_LIS3DH_Filter.cpp
+ *
+ *  Block low-pass filter and decimator for batches of raw LIS3DH samples.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Arduino.h"
+
+#include <Adafruit_LIS3DH_Filter.h>
+
+/*!
+ *  @brief  Instantiates a new filter
+ *  @param  shift
+ *          IIR coefficient, the filter moves 1/2^shift of the way towards
+ *          each new sample. 0 disables the low-pass stage
+ *  @param  factor
+ *          decimation factor, 1 keeps every sample
+ */
+Adafruit_LIS3DH_Filter::Adafruit_LIS3DH_Filter(uint8_t shift,
+                                               uint8_t factor) {
+  setLowPass(shift);
+  setDecimation(factor);
+}
+
+/*!
+ *  @brief  Sets the low-pass coefficient and resets the filter state
+ *  @param  shift
+ *          IIR coefficient as a power of two, 0 to 15. 0 disables the stage
+ */
+void Adafruit_LIS3DH_Filter::setLowPass(uint8_t shift) {
+  _shift = (shift > 15) ? 15 : shift;
+  reset();
+}
+
+/*!
+ *  @brief  Sets the decimation factor and resets the filter state
+ *  @param  factor
+ *          number of input samples averaged into each output sample
+ */
+void Adafruit_LIS3DH_Filter::setDecimation(uint8_t factor) {
+  _factor = factor ? factor : 1;
+  reset();
+}
+
+/*!
+ *  @brief  Forgets all previous samples
+ */
+void Adafruit_LIS3DH_Filter::reset(void) {
+  _phase = 0;
+  _primed = false;
+  for (uint8_t i = 0; i < 3; i++) {
+    _state[i] = 0;
+    _sum[i] = 0;
+  }
+}
+
+/*!
+ *  @brief  Filters and decimates a block of samples in place
+ *  @param  x
+ *          x axis samples, overwritten with the output
+ *  @param  y
+ *          y axis samples, overwritten with the output
+ *  @param  z
+ *          z axis samples, overwritten with the output
+ *  @param  count
+ *          number of input samples per axis
+ *  @return Number of output samples per axis
+ */
+uint8_t Adafruit_LIS3DH_Filter::process(int16_t *x, int16_t *y, int16_t *z,
+                                        uint8_t count) {
+  if (count == 0)
+    return 0;
+
+  if (!_primed) {
+    // start the IIR from the first sample instead of ramping up from 0
+    _state[0] = (int32_t)x[0] * 256;
+    _state[1] = (int32_t)y[0] * 256;
+    _state[2] = (int32_t)z[0] * 256;
+    _primed = true;
+  }
+
+  // every axis starts from the same decimation phase
+  uint8_t phase = _phase;
+  processAxis(x, count, 0);
+  _phase = phase;
+  processAxis(y, count, 1);
+  _phase = phase;
+  return processAxis(z, count, 2);
+}
+
+/*!
+ *  @brief  Runs one axis of a block through the filter
+ *  @param  data
+ *          samples, overwritten with the output
+ *  @param  count
+ *          number of input samples
+ *  @param  axis
+ *          axis index into the filter state
+ *  @return Number of output samples
+ */
+uint8_t Adafruit_LIS3DH_Filter::processAxis(int16_t *data, uint8_t count,
+                                            uint8_t axis) {
+  const uint8_t shift = _shift;
+  const uint8_t factor = _factor;
+
+  if (shift) {
+    // each output depends on the previous one, so unlike the decimator this
+    // loop is a plain recurrence and is not vectorised
+    int32_t state = _state[axis];
+    for (uint8_t i = 0; i < count; i++) {
+      state += (((int32_t)data[i] * 256) - state) >> shift;
+      data[i] = state / 256;
+    }
+    _state[axis] = state;
+  }
+
+  if (factor == 1)
+    return count;
+
+  int32_t sum = _sum[axis];
+  uint8_t phase = _phase;
+  uint8_t i = 0;
+  uint8_t out = 0;
+
+  // finish the group left over from the previous block
+  if (phase) {
+    uint8_t n = factor - phase;
+    if (n > count)
+      n = count;
+    for (; i < n; i++)
+      sum += data[i];
+    phase += n;
+    if (phase < factor) {
+      _sum[axis] = sum;
+      _phase = phase;
+      return 0;
+    }
+    data[out++] = sum / factor;
+  }
+
+  // then whole groups, each a fixed length sum with no branch inside;
+  // outputs never overtake inputs, so this can run in place
+  for (; i + factor <= count; i += factor) {
+    int32_t group = 0;
+    for (uint8_t k = 0; k < factor; k++)
+      group += data[i + k];
+    data[out++] = group / factor;
+  }
+
+  // and start the next group with whatever is left
+  sum = 0;
+  for (phase = 0; i < count; i++, phase++)
+    sum += data[i];
+  _sum[axis] = sum;
+  _phase = phase;
+  return out;
+}
+
+/*!
+ *  @brief  Splits samples from Adafruit_LIS3DH::readFIFO() into one array per
+ *          axis, as process() expects
+ *  @param  samples
+ *          samples to split
+ *  @param  count
+ *          number of samples
+ *  @param  x
+ *          x axis output
+ *  @param  y
+ *          y axis output
+ *  @param  z
+ *          z axis output
+ */
+void Adafruit_LIS3DH_Filter::deinterleave(const lis3dh_sample_t *samples,
+                                          uint8_t count, int16_t *x,
+                                          int16_t *y, int16_t *z) {
+  for (uint8_t i = 0; i < count; i++) {
+    x[i] = samples[i].x;
+    y[i] = samples[i].y;
+    z[i] = samples[i].z;
+  }
+}
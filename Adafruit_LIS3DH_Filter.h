@@ -0,0 +1,53 @@
+/*!
+ *  @file Adafruit_LIS3DH_Filter.h
+ *
+ *  Block low-pass filter and decimator for batches of raw LIS3DH samples,
+ *  such as those drained from the FIFO with Adafruit_LIS3DH::readFIFO().
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#ifndef ADAFRUIT_LIS3DH_FILTER_H
+#define ADAFRUIT_LIS3DH_FILTER_H
+
+#include <Adafruit_LIS3DH.h>
+
+/*!
+ *  @brief  Low-pass filters and decimates raw x/y/z samples a block at a time
+ *
+ *  Samples are processed in struct-of-arrays form, one int16_t array per
+ *  axis, so each inner loop runs over a single contiguous array. The filter
+ *  is a single-pole IIR, y += (x - y) / 2^shift, followed by averaging each
+ *  run of `factor` outputs down to one sample. State carries over between
+ *  blocks, so a stream can be fed in FIFO-sized pieces.
+ *
+ *  The decimator sums each group in a branch-free loop the compiler can
+ *  vectorise. The IIR is a recurrence, each output needing the previous
+ *  one, so it runs a sample at a time; set the shift to 0 to rely on the
+ *  decimator's averaging alone.
+ */
+class Adafruit_LIS3DH_Filter {
+public:
+  Adafruit_LIS3DH_Filter(uint8_t shift = 2, uint8_t factor = 1);
+
+  void setLowPass(uint8_t shift);
+  void setDecimation(uint8_t factor);
+  void reset(void);
+
+  uint8_t process(int16_t *x, int16_t *y, int16_t *z, uint8_t count);
+
+  static void deinterleave(const lis3dh_sample_t *samples, uint8_t count,
+                           int16_t *x, int16_t *y, int16_t *z);
+
+private:
+  uint8_t processAxis(int16_t *data, uint8_t count, uint8_t axis);
+
+  uint8_t _shift;    ///< IIR coefficient as a power of two, 0 to bypass
+  uint8_t _factor;   ///< Decimation factor, 1 to keep every sample
+  uint8_t _phase;    ///< Samples accumulated towards the next output
+  bool _primed;      ///< Whether _state holds a sample yet
+  int32_t _state[3]; ///< IIR state per axis, 8 fractional bits
+  int32_t _sum[3];   ///< Decimation accumulator per axis
+};
+
+#endif
@@ -0,0 +1,170 @@
+/*!
+ * @file Adafruit_LIS3DH_Group.cpp
+ *
+ *  Coordinates FIFO drains across several LIS3DH sensors.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#include "Arduino.h"
+
+#include <Adafruit_LIS3DH_Group.h>
+
+/*!
+ *  @brief  Instantiates a new, empty group
+ *  @param  schedule
+ *          order in which poll() drains the sensors
+ */
+Adafruit_LIS3DH_Group::Adafruit_LIS3DH_Group(lis3dh_schedule_t schedule) {
+  _schedule = schedule;
+}
+
+/*!
+ *  @brief  Adds a sensor to the group, switching it to the group's clock if
+ *          setClockSource() has been called
+ *  @param  sensor
+ *          sensor to add, which must outlive the group
+ *  @return Index of the sensor, as passed to the callback, or -1 if the
+ *          group is full
+ */
+int8_t Adafruit_LIS3DH_Group::add(Adafruit_LIS3DH *sensor) {
+  if ((sensor == NULL) || (_count >= LIS3DH_GROUP_MAX))
+    return -1;
+  if (_clockSet)
+    sensor->setClockSource(_clock);
+  _sensors[_count] = sensor;
+  return _count++;
+}
+
+/*!
+ *  @brief  Gets the number of sensors in the group
+ *  @return Number of sensors
+ */
+uint8_t Adafruit_LIS3DH_Group::size(void) { return _count; }
+
+/*!
+ *  @brief  Gets a sensor in the group
+ *  @param  index
+ *          index returned by add()
+ *  @return The sensor, or NULL if there is none at index
+ */
+Adafruit_LIS3DH *Adafruit_LIS3DH_Group::get(uint8_t index) {
+  return (index < _count) ? _sensors[index] : NULL;
+}
+
+/*!
+ *  @brief  Sets the order in which poll() drains the sensors
+ *  @param  schedule
+ *          LIS3DH_SCHEDULE_ROUND_ROBIN or LIS3DH_SCHEDULE_FILL_LEVEL
+ */
+void Adafruit_LIS3DH_Group::setSchedule(lis3dh_schedule_t schedule) {
+  _schedule = schedule;
+}
+
+/*!
+ *  @brief  Sets the function that receives each drained batch
+ *  @param  callback
+ *          batch receiver, NULL to discard the samples
+ */
+void Adafruit_LIS3DH_Group::setCallback(lis3dh_batch_callback_t callback) {
+  _callback = callback;
+}
+
+/*!
+ *  @brief  Sets the timestamp clock for every sensor in the group, now and
+ *          as they are added, so their batches share a time base
+ *  @param  clock
+ *          function returning microseconds, or NULL for micros()
+ */
+void Adafruit_LIS3DH_Group::setClockSource(lis3dh_clock_t clock) {
+  _clock = clock;
+  _clockSet = true;
+  for (uint8_t i = 0; i < _count; i++)
+    _sensors[i]->setClockSource(clock);
+}
+
+/*!
+ *  @brief  Drains pending samples from the sensors' FIFOs
+ *
+ *  Round robin drains the sensors in turn, carrying on where the previous
+ *  call left off. Fill level reads every FIFO depth first and drains the
+ *  fullest FIFOs first, so the sensors closest to overflowing are served
+ *  before the bus time runs out. Either way sensors with empty FIFOs are
+ *  skipped, and each batch goes to the callback before the next drain
+ *  reuses the buffer.
+ *
+ *  @param  maxDrains
+ *          maximum number of sensors to drain in this call
+ *  @return Number of samples delivered
+ */
+uint16_t Adafruit_LIS3DH_Group::poll(uint8_t maxDrains) {
+  uint16_t total = 0;
+  if (_count == 0)
+    return 0;
+
+  if (_schedule == LIS3DH_SCHEDULE_FILL_LEVEL) {
+    // the depths read here are reused for the drains, so each FIFO_SRC is
+    // read (and each overflow counted) once
+    uint8_t levels[LIS3DH_GROUP_MAX];
+    uint32_t counted[LIS3DH_GROUP_MAX];
+    for (uint8_t i = 0; i < _count; i++) {
+      levels[i] = _sensors[i]->getFIFOCount();
+      counted[i] = _sensors[i]->now();
+    }
+
+    while (maxDrains--) {
+      // ties go to whichever sensor is next in turn
+      uint8_t fullest = 0;
+      uint8_t level = 0;
+      for (uint8_t n = 0; n < _count; n++) {
+        uint8_t i = (_next + n) % _count;
+        if (levels[i] > level) {
+          fullest = i;
+          level = levels[i];
+        }
+      }
+      if (level == 0)
+        break;
+
+      levels[fullest] = 0;
+      _next = (fullest + 1) % _count;
+      total += drain(fullest, level, counted[fullest]);
+    }
+    return total;
+  }
+
+  for (uint8_t n = 0; (n < _count) && maxDrains; n++) {
+    uint8_t i = _next;
+    _next = (_next + 1) % _count;
+    Adafruit_LIS3DH *sensor = _sensors[i];
+    uint8_t depth = sensor->getFIFOCount();
+    uint8_t count = drain(i, depth, sensor->now());
+    if (count) {
+      total += count;
+      maxDrains--;
+    }
+  }
+  return total;
+}
+
+/*!
+ *  @brief  Drains one sensor's FIFO into the shared buffer and passes the
+ *          batch to the callback
+ *  @param  index
+ *          sensor to drain
+ *  @param  depth
+ *          FIFO depth, from getFIFOCount()
+ *  @param  counted
+ *          the sensor's now() when the depth was read
+ *  @return Number of samples drained
+ */
+uint8_t Adafruit_LIS3DH_Group::drain(uint8_t index, uint8_t depth,
+                                     uint32_t counted) {
+  if (depth == 0)
+    return 0;
+  uint8_t count =
+      _sensors[index]->readFIFO(_buffer, LIS3DH_FIFO_SIZE, depth, counted);
+  if (count && _callback)
+    _callback(index, _buffer, count);
+  return count;
+}
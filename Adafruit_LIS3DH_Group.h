@@ -0,0 +1,77 @@
+/*!
+ *  @file Adafruit_LIS3DH_Group.h
+ *
+ *  Coordinates FIFO drains across several LIS3DH sensors, e.g. two I2C
+ *  addresses per bus plus a number of SPI chip selects.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#ifndef ADAFRUIT_LIS3DH_GROUP_H
+#define ADAFRUIT_LIS3DH_GROUP_H
+
+#include <Adafruit_LIS3DH.h>
+
+#ifndef LIS3DH_GROUP_MAX
+#define LIS3DH_GROUP_MAX 8 ///< Number of sensors a group can hold
+#endif
+
+/*!
+ * @brief  Order in which Adafruit_LIS3DH_Group::poll() drains sensors
+ */
+typedef enum {
+  LIS3DH_SCHEDULE_ROUND_ROBIN, // each sensor in turn
+  LIS3DH_SCHEDULE_FILL_LEVEL,  // fullest FIFO first
+} lis3dh_schedule_t;
+
+/*!
+ *  @brief  Receives a batch of samples drained from one sensor in a group
+ *  @param  index
+ *          position of the sensor in the group, in the order it was added
+ *  @param  samples
+ *          samples, oldest first; only valid until the callback returns
+ *  @param  count
+ *          number of samples
+ */
+typedef void (*lis3dh_batch_callback_t)(uint8_t index,
+                                        const lis3dh_sample_t *samples,
+                                        uint8_t count);
+
+/*!
+ *  @brief  Drains the FIFOs of several sensors through one shared buffer
+ *
+ *  The sensors are set up and begun by the caller, with their FIFOs in
+ *  stream mode. poll() spreads the drains out so the buses are used evenly,
+ *  and hands each batch to the callback. The sensors share one timestamp
+ *  clock, so batches from different sensors line up in time.
+ */
+class Adafruit_LIS3DH_Group {
+public:
+  Adafruit_LIS3DH_Group(
+      lis3dh_schedule_t schedule = LIS3DH_SCHEDULE_ROUND_ROBIN);
+
+  int8_t add(Adafruit_LIS3DH *sensor);
+  uint8_t size(void);
+  Adafruit_LIS3DH *get(uint8_t index);
+
+  void setSchedule(lis3dh_schedule_t schedule);
+  void setCallback(lis3dh_batch_callback_t callback);
+  void setClockSource(lis3dh_clock_t clock);
+
+  uint16_t poll(uint8_t maxDrains = LIS3DH_GROUP_MAX);
+
+private:
+  uint8_t drain(uint8_t index, uint8_t depth, uint32_t counted);
+
+  Adafruit_LIS3DH *_sensors[LIS3DH_GROUP_MAX]; ///< Sensors, not owned
+  uint8_t _count = 0;                          ///< Sensors in _sensors
+  uint8_t _next = 0;                           ///< Next sensor in turn
+  lis3dh_schedule_t _schedule;                 ///< Drain order
+  lis3dh_batch_callback_t _callback = NULL;    ///< Batch receiver
+  lis3dh_clock_t _clock = NULL; ///< Clock shared by all the sensors
+  bool _clockSet = false;       ///< setClockSource() has been called
+
+  lis3dh_sample_t _buffer[LIS3DH_FIFO_SIZE]; ///< Shared transfer buffer
+};
+
+#endif
@@ -0,0 +1,381 @@
+/*!
+ *  @file Adafruit_LIS3DH_Lite.h
+ *
+ *  Thin LIS3DH front-end with the bus fixed at compile time.
+ *
+ *  Adafruit_LIS3DH picks I2C or SPI at run time, so every transaction checks
+ *  which device is in use and both BusIO device classes are linked in.
+ *  Adafruit_LIS3DH_Lite takes the bus as a template argument instead:
+ *
+ *      Adafruit_LIS3DH_Lite<LIS3DH_I2CTransport> lis;          // 0x18
+ *      Adafruit_LIS3DH_Lite<LIS3DH_SPITransport> lis(10);      // CS on 10
+ *
+ *  The register primitives inline straight into a call on the one device,
+ *  and the other device class is never referenced, so with the usual
+ *  -ffunction-sections / --gc-sections it is left out of the build along
+ *  with the parts of Adafruit_LIS3DH the sketch does not call.
+ *
+ *  The front-end only covers the sample path: start-up, raw reads and FIFO
+ *  drains. Convert the raw values with Adafruit_LIS3DH::convert() or
+ *  convertMilliG(), and use the register primitives, or Adafruit_LIS3DH,
+ *  for anything else.
+ *
+ *  BSD license, all text above must be included in any redistribution
+ */
+
+#ifndef ADAFRUIT_LIS3DH_LITE_H
+#define ADAFRUIT_LIS3DH_LITE_H
+
+#include <Adafruit_LIS3DH.h>
+
+/*!
+ *  @brief  I2C transport for Adafruit_LIS3DH_Lite
+ */
+class LIS3DH_I2CTransport {
+public:
+  /*!
+   *  @brief  Instantiates the transport
+   *  @param  addr
+   *          I2C address, 0x18 or 0x19
+   *  @param  wire
+   *          I2C bus
+   */
+  LIS3DH_I2CTransport(uint8_t addr = LIS3DH_DEFAULT_ADDRESS,
+                      TwoWire *wire = &Wire)
+      : _dev(addr, wire) {}
+  LIS3DH_I2CTransport(const LIS3DH_I2CTransport &) = delete;
+  LIS3DH_I2CTransport &operator=(const LIS3DH_I2CTransport &) = delete;
+
+  /*!
+   *  @brief  Starts the bus and checks the sensor answers
+   *  @return true if successful
+   */
+  bool begin(void) { return _dev.begin(); }
+
+  /*!
+   *  @brief  Reads consecutive registers in one transaction
+   *  @param  reg
+   *          first register
+   *  @param  buffer
+   *          destination for len bytes
+   *  @param  len
+   *          number of bytes, at most burstSamples() * 6
+   *  @return true if successful
+   */
+  bool read(uint8_t reg, uint8_t *buffer, uint8_t len) {
+    uint8_t address = reg | LIS3DH_I2C_AUTOINC;
+    LIS3DH_BUS_BEGIN(reg, len, false);
+    bool ok = _dev.write_then_read(&address, 1, buffer, len);
+    LIS3DH_BUS_END(reg, len, false);
+    return ok;
+  }
+
+  /*!
+   *  @brief  Writes consecutive registers in one transaction
+   *  @param  reg
+   *          first register
+   *  @param  buffer
+   *          len bytes to write
+   *  @param  len
+   *          number of bytes
+   *  @return true if successful
+   */
+  bool write(uint8_t reg, const uint8_t *buffer, uint8_t len) {
+    uint8_t address = reg | LIS3DH_I2C_AUTOINC;
+    LIS3DH_BUS_BEGIN(reg, len, true);
+    bool ok = _dev.write(buffer, len, true, &address, 1);
+    LIS3DH_BUS_END(reg, len, true);
+    return ok;
+  }
+
+  /*!
+   *  @brief  Gets how many x/y/z samples fit in one read
+   *  @return Samples per burst, limited by the I2C buffer
+   */
+  uint8_t burstSamples(void) {
+    uint8_t n = _dev.maxBufferSize() / 6;
+    return n ? n : 1;
+  }
+
+private:
+  Adafruit_I2CDevice _dev;
+};
+
+/*!
+ *  @brief  Hardware SPI transport for Adafruit_LIS3DH_Lite
+ */
+class LIS3DH_SPITransport {
+public:
+  /*!
+   *  @brief  Instantiates the transport
+   *  @param  cs
+   *          chip select pin
+   *  @param  spi
+   *          SPI bus
+   *  @param  frequency
+   *          SPI clock
+   */
+  LIS3DH_SPITransport(int8_t cs, SPIClass *spi = &SPI,
+                      uint32_t frequency = LIS3DH_DEFAULT_SPIFREQ)
+      : _dev(cs, frequency, SPI_BITORDER_MSBFIRST, SPI_MODE0, spi) {}
+  LIS3DH_SPITransport(const LIS3DH_SPITransport &) = delete;
+  LIS3DH_SPITransport &operator=(const LIS3DH_SPITransport &) = delete;
+
+  /*!
+   *  @brief  Starts the bus
+   *  @return true if successful
+   */
+  bool begin(void) { return _dev.begin(); }
+
+  /*!
+   *  @brief  Reads consecutive registers in one transaction
+   *  @param  reg
+   *          first register
+   *  @param  buffer
+   *          destination for len bytes
+   *  @param  len
+   *          number of bytes
+   *  @return true if successful
+   */
+  bool read(uint8_t reg, uint8_t *buffer, uint8_t len) {
+    uint8_t address = reg | LIS3DH_SPI_AUTOINC | LIS3DH_SPI_READ;
+    LIS3DH_BUS_BEGIN(reg, len, false);
+    bool ok = _dev.write_then_read(&address, 1, buffer, len);
+    LIS3DH_BUS_END(reg, len, false);
+    return ok;
+  }
+
+  /*!
+   *  @brief  Writes consecutive registers in one transaction
+   *  @param  reg
+   *          first register
+   *  @param  buffer
+   *          len bytes to write
+   *  @param  len
+   *          number of bytes
+   *  @return true if successful
+   */
+  bool write(uint8_t reg, const uint8_t *buffer, uint8_t len) {
+    uint8_t address = reg | LIS3DH_SPI_AUTOINC;
+    LIS3DH_BUS_BEGIN(reg, len, true);
+    bool ok = _dev.write(buffer, len, &address, 1);
+    LIS3DH_BUS_END(reg, len, true);
+    return ok;
+  }
+
+  /*!
+   *  @brief  Gets how many x/y/z samples fit in one read
+   *  @return Samples per burst, the whole FIFO on SPI
+   */
+  uint8_t burstSamples(void) { return LIS3DH_FIFO_SIZE; }
+
+private:
+  Adafruit_SPIDevice _dev;
+};
+
+/*!
+ *  @brief  LIS3DH sample path over a bus chosen at compile time
+ *  @tparam Transport
+ *          LIS3DH_I2CTransport, LIS3DH_SPITransport, or any class with the
+ *          same begin(), read(), write() and burstSamples()
+ */
+template <class Transport> class Adafruit_LIS3DH_Lite {
+public:
+  /*!
+   *  @brief  Instantiates the sensor, passing the arguments on to the
+   *          transport, e.g. the I2C address or the SPI chip select pin
+   *  @param  args
+   *          transport constructor arguments
+   */
+  template <typename... Args>
+  explicit Adafruit_LIS3DH_Lite(Args... args) : _bus(args...) {}
+
+  /*!
+   *  @brief  Starts the bus and puts the sensor in the same state as
+   *          Adafruit_LIS3DH::begin() does: all axes, high resolution, BDU,
+   *          DRDY on INT1 and the ADC on
+   *  @param  dataRate
+   *          output data rate
+   *  @param  range
+   *          full scale range
+   *  @param  nWAI
+   *          expected WHO_AM_I value
+   *  @return true if successful
+   */
+  bool begin(lis3dh_dataRate_t dataRate = LIS3DH_DATARATE_400_HZ,
+             lis3dh_range_t range = LIS3DH_RANGE_2_G, uint8_t nWAI = 0x33) {
+    if (!_bus.begin() || (readRegister(LIS3DH_REG_WHOAMI) != nWAI))
+      return false;
+    // CTRL_REG1 - CTRL_REG6 in one burst; BDU and HR in CTRL_REG4, with
+    // BLE, self test and SIM cleared
+    uint8_t ctrl[6] = {(uint8_t)((dataRate << 4) | 0x07), 0x00,
+                       LIS3DH_INT1_DRDY1,
+                       (uint8_t)(0x88 | ((range & 0x03) << 4)), 0x00, 0x00};
+    if (!writeRegisters(LIS3DH_REG_CTRL1, ctrl, 6))
+      return false;
+    _range = range;
+    delay(15); // let the new range settle
+    return writeRegister(LIS3DH_REG_TEMPCFG, 0x80); // ADC on, temperature off
+  }
+
+  /*!
+   *  @brief  Gets the multiplier for the raw readings, for
+   *          Adafruit_LIS3DH::convert()
+   *  @param  ms2
+   *          true for m/s^2, false for g
+   *  @return Acceleration per LSB
+   */
+  float getScale(bool ms2 = true) {
+    return Adafruit_LIS3DH::getScale(_range, LIS3DH_MODE_HIGH_RESOLUTION, ms2);
+  }
+
+  /*!
+   *  @brief  Reads the current x, y and z output registers
+   *  @param  xyz
+   *          destination for three raw readings
+   *  @return true if successful
+   */
+  bool read(int16_t *xyz) {
+    if (!readRegisters(LIS3DH_REG_OUT_X_L, (uint8_t *)xyz, 6))
+      return false;
+    unpack(xyz, 3);
+    return true;
+  }
+
+  /*!
+   *  @brief  Reads x, y and z only if there is new data, fetching the status
+   *          register in the same transaction
+   *  @param  xyz
+   *          destination for three raw readings
+   *  @param  overrun
+   *          optional, set to true if a sample was overwritten unread
+   *  @return true if new data was read
+   */
+  bool readIfNew(int16_t *xyz, bool *overrun = NULL) {
+    uint8_t buffer[7]; // STATUS_REG sits right before OUT_X_L
+    if (!readRegisters(LIS3DH_REG_STATUS2, buffer, 7))
+      return false;
+    if (overrun)
+      *overrun = buffer[0] & 0x80; // ZYXOR
+    if (!(buffer[0] & 0x08))       // ZYXDA
+      return false;
+    memcpy(xyz, buffer + 1, 6);
+    unpack(xyz, 3);
+    return true;
+  }
+
+  /*!
+   *  @brief  Sets the FIFO mode, enabling the FIFO for anything but bypass
+   *  @param  mode
+   *          FIFO mode, e.g. LIS3DH_FIFO_STREAM
+   *  @return true if successful
+   */
+  bool setFIFOMode(lis3dh_fifo_mode_t mode) {
+    uint8_t ctrl5 = readRegister(LIS3DH_REG_CTRL5);
+    ctrl5 = (ctrl5 & ~0x40) | ((mode != LIS3DH_FIFO_BYPASS) ? 0x40 : 0x00);
+    uint8_t fifo_ctrl = readRegister(LIS3DH_REG_FIFOCTRL);
+    return writeRegister(LIS3DH_REG_CTRL5, ctrl5) &&
+           writeRegister(LIS3DH_REG_FIFOCTRL, (fifo_ctrl & 0x3F) | (mode << 6));
+  }
+
+  /*!
+   *  @brief  Gets the number of samples waiting in the FIFO
+   *  @return Number of samples, 32 if it has overflowed
+   */
+  uint8_t getFIFOCount(void) {
+    uint8_t src = readRegister(LIS3DH_REG_FIFOSRC);
+    return (src & 0x40) ? LIS3DH_FIFO_SIZE : (src & 0x1F); // OVRN, FSS4-0
+  }
+
+  /*!
+   *  @brief  Drains the FIFO in as few bursts as the bus allows
+   *  @param  xyz
+   *          destination for maxCount x/y/z triples, oldest first
+   *  @param  maxCount
+   *          maximum number of samples to read
+   *  @return Number of samples read
+   */
+  uint8_t readFIFO(int16_t *xyz, uint8_t maxCount = LIS3DH_FIFO_SIZE) {
+    uint8_t depth = getFIFOCount();
+    uint8_t count = (depth > maxCount) ? maxCount : depth;
+    // restart each burst on a sample boundary so the register pointer stays
+    // in step
+    uint8_t per_burst = _bus.burstSamples();
+    for (uint8_t done = 0; done < count;) {
+      uint8_t n = count - done;
+      if (n > per_burst)
+        n = per_burst;
+      if (!readRegisters(LIS3DH_REG_OUT_X_L, (uint8_t *)&xyz[done * 3], n * 6))
+        return done;
+      done += n;
+    }
+    unpack(xyz, count * 3);
+    return count;
+  }
+
+  /*!
+   *  @brief  Reads consecutive registers in one transaction
+   *  @param  reg
+   *          first register
+   *  @param  buffer
+   *          destination for len bytes
+   *  @param  len
+   *          number of bytes
+   *  @return true if successful
+   */
+  bool readRegisters(uint8_t reg, uint8_t *buffer, uint8_t len) {
+    return _bus.read(reg, buffer, len);
+  }
+
+  /*!
+   *  @brief  Writes consecutive registers in one transaction
+   *  @param  reg
+   *          first register
+   *  @param  buffer
+   *          len bytes to write
+   *  @param  len
+   *          number of bytes
+   *  @return true if successful
+   */
+  bool writeRegisters(uint8_t reg, const uint8_t *buffer, uint8_t len) {
+    return _bus.write(reg, buffer, len);
+  }
+
+  /*!
+   *  @brief  Reads a single register
+   *  @param  reg
+   *          register address
+   *  @return Register value, 0 if the read failed
+   */
+  uint8_t readRegister(uint8_t reg) {
+    uint8_t value = 0;
+    readRegisters(reg, &value, 1);
+    return value;
+  }
+
+  /*!
+   *  @brief  Writes a single register
+   *  @param  reg
+   *          register address
+   *  @param  value
+   *          value to write
+   *  @return true if successful
+   */
+  bool writeRegister(uint8_t reg, uint8_t value) {
+    return writeRegisters(reg, &value, 1);
+  }
+
+private:
+  // turns little-endian register bytes into int16_t values in place; this
+  // compiles to nothing on little-endian targets
+  static void unpack(int16_t *values, uint8_t count) {
+    uint8_t *bytes = (uint8_t *)values;
+    for (uint8_t i = 0; i < count; i++)
+      values[i] = bytes[i * 2] | ((uint16_t)bytes[i * 2 + 1] << 8);
+  }
+
+  Transport _bus;                            ///< Bus, fixed at compile time
+  lis3dh_range_t _range = LIS3DH_RANGE_2_G; ///< Range set by begin()
+};
+
+#endif
@@ -41,23 +41,22 @@ void setup(void) {
 
 
 void loop() {
-  int16_t adc;
+  int16_t adc1, adc2, adc3;
   uint16_t volt;
   
-  // read the ADCs
-  adc = lis.readADC(1);
-  volt = map(adc, -32512, 32512, 1800, 900);
-  Serial.print("ADC1:\t"); Serial.print(adc); 
+  // read the ADCs, all three in one go
+  lis.readADCs(&adc1, &adc2, &adc3);
+
+  volt = map(adc1, -32512, 32512, 1800, 900);
+  Serial.print("ADC1:\t"); Serial.print(adc1); 
   Serial.print(" ("); Serial.print(volt); Serial.print(" mV)  ");
   
-  adc = lis.readADC(2);
-  volt = map(adc, -32512, 32512, 1800, 900);
-  Serial.print("ADC2:\t"); Serial.print(adc); 
+  volt = map(adc2, -32512, 32512, 1800, 900);
+  Serial.print("ADC2:\t"); Serial.print(adc2); 
   Serial.print(" ("); Serial.print(volt); Serial.print(" mV)  ");
 
-  adc = lis.readADC(3);
-  volt = map(adc, -32512, 32512, 1800, 900);
-  Serial.print("ADC3:\t"); Serial.print(adc); 
+  volt = map(adc3, -32512, 32512, 1800, 900);
+  Serial.print("ADC3:\t"); Serial.print(adc3); 
   Serial.print(" ("); Serial.print(volt); Serial.print(" mV)");
 
   Serial.println();
@@ -0,0 +1,113 @@
+// Timing benchmark for the Adafruit LIS3DH public API
+//
+// Runs each call a number of times at several bus clocks and prints the
+// average time per call in microseconds. Use it to spot regressions in hot
+// paths such as read() before they turn into dropped samples.
+//
+// Build with -DLIS3DH_BUS_HOOKS (e.g. build_flags in PlatformIO) to also
+// print the bus transactions and bytes per call. For a board independent
+// count of the bus traffic and bus time of every call, run `make bench` in
+// extras/test on a computer instead.
+
+#include <Wire.h>
+#include <SPI.h>
+#include <Adafruit_LIS3DH.h>
+#include <Adafruit_Sensor.h>
+
+// Used for hardware SPI
+#define LIS3DH_CS 10
+
+// Uncomment to benchmark hardware SPI instead of I2C
+//#define BENCHMARK_SPI
+
+#define ITERATIONS 200
+
+#ifdef BENCHMARK_SPI
+const uint32_t clocks[] = {500000, 1000000, 4000000, 10000000};
+#else
+const uint32_t clocks[] = {100000, 400000, 1000000};
+#endif
+#define NUM_CLOCKS (sizeof(clocks) / sizeof(clocks[0]))
+
+Adafruit_LIS3DH *lis;
+sensors_event_t event;
+
+void report(const char *name, uint32_t elapsed) {
+  Serial.print("  ");
+  Serial.print(name);
+  Serial.print(":\t");
+  Serial.print((float)elapsed / ITERATIONS);
+  Serial.print(" us/call");
+
+#ifdef LIS3DH_BUS_HOOKS
+  uint8_t slots;
+  const lis3dh_bus_timing_t *timings = lis3dh_getBusTimings(&slots);
+  uint32_t transactions = 0, bytes = 0;
+  for (uint8_t i = 0; i < slots; i++) {
+    transactions += timings[i].count;
+    bytes += timings[i].bytes;
+  }
+  Serial.print("\t");
+  Serial.print((float)transactions / ITERATIONS);
+  Serial.print(" transactions/call\t");
+  Serial.print((float)bytes / ITERATIONS);
+  Serial.print(" bytes/call");
+#endif
+  Serial.println();
+}
+
+#ifdef LIS3DH_BUS_HOOKS
+#define RESET_BUS_TIMINGS() lis3dh_resetBusTimings()
+#else
+#define RESET_BUS_TIMINGS()
+#endif
+
+#define BENCH(name, call)                                                    \
+  do {                                                                       \
+    RESET_BUS_TIMINGS();                                                     \
+    uint32_t start = micros();                                               \
+    for (uint16_t i = 0; i < ITERATIONS; i++) {                              \
+      call;                                                                  \
+    }                                                                        \
+    report(name, micros() - start);                                          \
+  } while (0)
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("LIS3DH benchmark");
+
+  for (uint8_t c = 0; c < NUM_CLOCKS; c++) {
+#ifdef BENCHMARK_SPI
+    lis = new Adafruit_LIS3DH(LIS3DH_CS, &SPI, clocks[c]);
+    if (! lis->begin()) {
+#else
+    lis = new Adafruit_LIS3DH();
+    if (! lis->begin(0x18)) {   // change this to 0x19 for alternative i2c address
+#endif
+      Serial.println("Couldnt start");
+      while (1) yield();
+    }
+#ifndef BENCHMARK_SPI
+    Wire.setClock(clocks[c]);
+#endif
+
+    Serial.print("Bus clock "); Serial.print(clocks[c]); Serial.println(" Hz");
+
+    BENCH("read()", lis->read());
+    BENCH("getEvent()", lis->getEvent(&event));
+    BENCH("haveNewData()", lis->haveNewData());
+    BENCH("readADC(1)", lis->readADC(1));
+    BENCH("getClick()", lis->getClick());
+    // alternate between two thresholds so every call writes
+    BENCH("setClick()", lis->setClick(2, (i & 1) ? 80 : 40));
+    BENCH("getRange()", lis->getRange());
+    Serial.println();
+
+    delete lis;
+  }
+}
+
+void loop() {
+}
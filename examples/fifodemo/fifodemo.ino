@@ -0,0 +1,53 @@
+// Basic demo for batched FIFO readings from Adafruit LIS3DH
+
+#include <Wire.h>
+#include <SPI.h>
+#include <Adafruit_LIS3DH.h>
+#include <Adafruit_Sensor.h>
+
+// Used for software SPI
+#define LIS3DH_CLK 13
+#define LIS3DH_MISO 12
+#define LIS3DH_MOSI 11
+// Used for hardware & software SPI
+#define LIS3DH_CS 10
+
+// software SPI
+//Adafruit_LIS3DH lis = Adafruit_LIS3DH(LIS3DH_CS, LIS3DH_MOSI, LIS3DH_MISO, LIS3DH_CLK);
+// hardware SPI
+//Adafruit_LIS3DH lis = Adafruit_LIS3DH(LIS3DH_CS);
+// I2C
+Adafruit_LIS3DH lis = Adafruit_LIS3DH();
+
+lis3dh_sample_t samples[LIS3DH_FIFO_SIZE];
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("LIS3DH FIFO test!");
+
+  if (! lis.begin(0x18)) {   // change this to 0x19 for alternative i2c address
+    Serial.println("Couldnt start");
+    while (1) yield();
+  }
+  Serial.println("LIS3DH found!");
+
+  lis.setDataRate(LIS3DH_DATARATE_400_HZ);
+  // keep the newest 32 samples, so nothing is lost while we are busy
+  lis.setFIFOMode(LIS3DH_FIFO_STREAM);
+}
+
+void loop() {
+  // at 400 Hz the FIFO fills in 80 ms, so we can do other work in between
+  delay(50);
+
+  uint8_t count = lis.readFIFO(samples, LIS3DH_FIFO_SIZE);
+  Serial.print("Read "); Serial.print(count); Serial.println(" samples");
+
+  for (uint8_t i = 0; i < count; i++) {
+    Serial.print("X:  "); Serial.print(samples[i].x);
+    Serial.print("  \tY:  "); Serial.print(samples[i].y);
+    Serial.print("  \tZ:  "); Serial.println(samples[i].z);
+  }
+}
@@ -0,0 +1,50 @@
+// Demo for the compile-time bus front-end of the Adafruit LIS3DH library
+//
+// Adafruit_LIS3DH_Lite fixes the bus in the sketch, so only the I2C or the
+// SPI code is built in and reads go straight to it. It covers start-up, raw
+// reads and FIFO drains; use Adafruit_LIS3DH for the rest of the features.
+
+#include <Wire.h>
+#include <SPI.h>
+#include <Adafruit_LIS3DH_Lite.h>
+
+// Used for hardware SPI
+#define LIS3DH_CS 10
+
+// hardware SPI
+//Adafruit_LIS3DH_Lite<LIS3DH_SPITransport> lis(LIS3DH_CS);
+// I2C, change this to 0x19 for alternative i2c address
+Adafruit_LIS3DH_Lite<LIS3DH_I2CTransport> lis(0x18);
+
+int16_t raw[LIS3DH_FIFO_SIZE * 3];
+float accel[LIS3DH_FIFO_SIZE * 3];
+float scale;
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("LIS3DH Lite test!");
+
+  if (! lis.begin(LIS3DH_DATARATE_100_HZ, LIS3DH_RANGE_4_G)) {
+    Serial.println("Couldnt start");
+    while (1) yield();
+  }
+  Serial.println("LIS3DH found!");
+
+  scale = lis.getScale(); // m/s^2 per LSB
+  lis.setFIFOMode(LIS3DH_FIFO_STREAM);
+}
+
+void loop() {
+  // drain whatever the FIFO collected and convert it in one go
+  uint8_t count = lis.readFIFO(raw);
+  Adafruit_LIS3DH::convert(raw, accel, count * 3, scale);
+
+  for (uint8_t i = 0; i < count; i++) {
+    Serial.print(accel[i * 3]); Serial.print("\t");
+    Serial.print(accel[i * 3 + 1]); Serial.print("\t");
+    Serial.print(accel[i * 3 + 2]); Serial.println(" m/s^2");
+  }
+  delay(200);
+}
@@ -0,0 +1,54 @@
+// Demo for draining several Adafruit LIS3DH sensors through one group
+
+#include <Wire.h>
+#include <SPI.h>
+#include <Adafruit_LIS3DH.h>
+#include <Adafruit_LIS3DH_Group.h>
+#include <Adafruit_Sensor.h>
+
+// Used for hardware SPI
+#define LIS3DH_CS 10
+
+// two sensors on I2C, at 0x18 and 0x19, and one on hardware SPI
+Adafruit_LIS3DH lis_a = Adafruit_LIS3DH();
+Adafruit_LIS3DH lis_b = Adafruit_LIS3DH();
+Adafruit_LIS3DH lis_c = Adafruit_LIS3DH(LIS3DH_CS);
+
+Adafruit_LIS3DH_Group group(LIS3DH_SCHEDULE_FILL_LEVEL);
+
+void printBatch(uint8_t index, const lis3dh_sample_t *samples, uint8_t count) {
+  Serial.print("Sensor "); Serial.print(index);
+  Serial.print(": "); Serial.print(count); Serial.print(" samples from ");
+  Serial.print(samples[0].timestamp); Serial.print(" to ");
+  Serial.print(samples[count - 1].timestamp); Serial.println(" us");
+}
+
+void startSensor(Adafruit_LIS3DH &lis, uint8_t addr) {
+  if (! lis.begin(addr)) {
+    Serial.println("Couldnt start");
+    while (1) yield();
+  }
+  lis.setDataRate(LIS3DH_DATARATE_100_HZ);
+  // keep the newest 32 samples until the group gets round to this sensor
+  lis.setFIFOMode(LIS3DH_FIFO_STREAM);
+  group.add(&lis);
+}
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("LIS3DH multi-sensor test!");
+
+  startSensor(lis_a, 0x18);
+  startSensor(lis_b, 0x19);
+  startSensor(lis_c, 0x18);   // the address is ignored for SPI
+  group.setCallback(printBatch);
+}
+
+void loop() {
+  // at 100 Hz each FIFO fills in 320 ms; drain at most two sensors per pass
+  // so the bus time is spread out
+  group.poll(2);
+  delay(50);
+}
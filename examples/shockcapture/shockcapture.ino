@@ -0,0 +1,65 @@
+// Demo for capturing the samples around a shock with the Adafruit LIS3DH,
+// using the FIFO to hold the samples from before the shock
+
+#include <Wire.h>
+#include <SPI.h>
+#include <Adafruit_LIS3DH.h>
+#include <Adafruit_Sensor.h>
+
+// Used for software SPI
+#define LIS3DH_CLK 13
+#define LIS3DH_MISO 12
+#define LIS3DH_MOSI 11
+// Used for hardware & software SPI
+#define LIS3DH_CS 10
+
+// software SPI
+//Adafruit_LIS3DH lis = Adafruit_LIS3DH(LIS3DH_CS, LIS3DH_MOSI, LIS3DH_MISO, LIS3DH_CLK);
+// hardware SPI
+//Adafruit_LIS3DH lis = Adafruit_LIS3DH(LIS3DH_CS);
+// I2C
+Adafruit_LIS3DH lis = Adafruit_LIS3DH();
+
+// up to 32 samples before the shock, the rest after it
+#define CAPTURE_SIZE 64
+lis3dh_sample_t samples[CAPTURE_SIZE];
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial) delay(10);     // will pause Zero, Leonardo, etc until serial console opens
+
+  Serial.println("LIS3DH shock capture test!");
+
+  if (! lis.begin(0x18)) {   // change this to 0x19 for alternative i2c address
+    Serial.println("Couldnt start");
+    while (1) yield();
+  }
+  Serial.println("LIS3DH found!");
+
+  lis.setDataRate(LIS3DH_DATARATE_400_HZ);
+  lis.setRange(LIS3DH_RANGE_8_G);
+
+  // trigger when any axis goes over 2 g, latched on INT1
+  lis.setInterruptGenerator(1, LIS3DH_INT_OR,
+                            LIS3DH_INT_XHIGH | LIS3DH_INT_YHIGH |
+                                LIS3DH_INT_ZHIGH,
+                            2000, 0);
+}
+
+void loop() {
+  uint8_t pre;
+  uint16_t count = lis.captureShock(samples, CAPTURE_SIZE, 1, 10000, &pre);
+  if (count == 0) {
+    Serial.println("No shock");
+    return;
+  }
+
+  Serial.print("Shock! "); Serial.print(pre); Serial.print(" samples before, ");
+  Serial.print(count - pre); Serial.println(" after");
+  for (uint16_t i = 0; i < count; i++) {
+    Serial.print(samples[i].timestamp); Serial.print(" us");
+    Serial.print("  \tX:  "); Serial.print(samples[i].x);
+    Serial.print("  \tY:  "); Serial.print(samples[i].y);
+    Serial.print("  \tZ:  "); Serial.println(samples[i].z);
+  }
+}
@@ -19,10 +19,20 @@
 // I2C
 Adafruit_LIS3DH lis = Adafruit_LIS3DH();
 
-// Adjust this number for the sensitivity of the 'click' force
-// this strongly depend on the range! for 16G, try 5-10
-// for 8G, try 10-20. for 4G try 20-40. for 2G try 40-80
-#define CLICKTHRESHHOLD 80
+// Adjust this number for the sensitivity of the 'click' force, in milli-g
+#define CLICKTHRESHHOLD_MG 1250
+
+// Connect the LIS3DH INT pin here, it must support attachInterrupt()
+#define LIS3DH_INT_PIN 2
+
+volatile bool tapped = false;
+
+// queue for taps collected but not yet printed
+lis3dh_tap_t taps[8];
+
+void tapISR(void) {
+  tapped = true;
+}
 
 void setup(void) {
 #ifndef ESP8266
@@ -43,24 +53,37 @@ void setup(void) {
   Serial.print("Range = "); Serial.print(2 << lis.getRange());  
   Serial.println("G");
 
+  // only taps should raise INT1
+  lis.enableDRDY(false);
+
   // 0 = turn off click detection & interrupt
   // 1 = single click only interrupt output
   // 2 = double click only interrupt output, detect single click
   // Adjust threshhold, higher numbers are less sensitive
-  lis.setClick(2, CLICKTHRESHHOLD);
-  delay(100);
+  lis.setTap(2, CLICKTHRESHHOLD_MG);
+  lis.setTapBuffer(taps, 8);
+
+  pinMode(LIS3DH_INT_PIN, INPUT);
+  attachInterrupt(digitalPinToInterrupt(LIS3DH_INT_PIN), tapISR, RISING);
+  lis.collectTap(); // clear any tap latched before the ISR was attached
 }
 
 
 void loop() {
-  uint8_t click = lis.getClick();
-  if (click == 0) return;
-  if (! (click & 0x30)) return;
-  Serial.print("Click detected (0x"); Serial.print(click, HEX); Serial.print("): ");
-  if (click & 0x10) Serial.print(" single click");
-  if (click & 0x20) Serial.print(" double click");
-  Serial.println();
-
-  delay(100);
-  return;
+  // the bus can't be used from the ISR on every core, so collect it here
+  if (tapped) {
+    tapped = false;
+    lis.collectTap();
+  }
+
+  lis3dh_tap_t tap;
+  while (lis.popTap(&tap)) {
+    Serial.print(tap.timestamp / 1000); Serial.print(" ms: ");
+    Serial.print(tap.doubleTap ? "double click" : "single click");
+    Serial.print(tap.negative ? " -" : " +");
+    if (tap.axes & 1) Serial.print("X");
+    if (tap.axes & 2) Serial.print("Y");
+    if (tap.axes & 4) Serial.print("Z");
+    Serial.println();
+  }
 }
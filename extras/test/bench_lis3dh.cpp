@@ -0,0 +1,144 @@
+/*!
+ *  @file bench_lis3dh.cpp
+ *
+ *  Bus cost benchmark for the LIS3DH driver, run against the register level
+ *  simulator in lis3dh_sim.h. Build and run with `make bench` in this
+ *  directory.
+ *
+ *  Each call is run a number of times on a simulated I2C and SPI sensor and
+ *  the transactions and data bytes it puts on the bus are counted. These are
+ *  turned into bus time per call for several clocks:
+ *
+ *  - I2C read: START, address+W, register, repeated START, address+R, the
+ *    data bytes, STOP; 9 bits per byte and a bit time for each condition.
+ *  - I2C write: START, address+W, register, the data bytes, STOP.
+ *  - SPI: the register byte and the data bytes, 8 bits each.
+ *
+ *  This is the time the bus is busy, not including driver or Wire/SPI
+ *  library overhead, so it is a lower bound that is the same on every board.
+ */
+
+#include <stdio.h>
+
+#include "lis3dh_sim.h"
+
+#define ITERATIONS 100
+
+static const uint32_t i2c_clocks[] = {100000, 400000, 1000000};
+static const uint32_t spi_clocks[] = {1000000, 5000000, 10000000};
+
+/*!
+ *  @brief  One bus and the clocks to report it at
+ */
+struct Bus {
+  const char *name;       ///< printed in the table header
+  bool spi;               ///< SPI framing rather than I2C
+  const uint32_t *clocks; ///< bus clocks in Hz
+  uint8_t numClocks;      ///< entries in clocks
+};
+
+static void header(const Bus &bus) {
+  printf("\n%s\n%-24s %8s %8s", bus.name, "call", "trans", "bytes");
+  for (uint8_t c = 0; c < bus.numClocks; c++)
+    printf(" %6lukHz", (unsigned long)(bus.clocks[c] / 1000));
+  printf("\n");
+}
+
+/*!
+ *  @brief  Runs call ITERATIONS times, with setup (not counted) before each,
+ *          and prints the bus cost per call
+ */
+template <typename Setup, typename Call>
+static void bench(const Bus &bus, LIS3DH_Sim &sim, const char *name,
+                  Setup setup, Call call) {
+  uint32_t transactions = 0, reads = 0, bytes = 0;
+  for (uint16_t i = 0; i < ITERATIONS; i++) {
+    setup(i);
+    uint32_t t = sim.transactions, r = sim.reads, b = sim.bytes;
+    call(i);
+    transactions += sim.transactions - t;
+    reads += sim.reads - r;
+    bytes += sim.bytes - b;
+  }
+
+  uint32_t bits;
+  if (bus.spi)
+    bits = 8 * (transactions + bytes);
+  else
+    bits = 30 * reads + 20 * (transactions - reads) + 9 * bytes;
+
+  printf("%-24s %8.2f %8.2f", name, (double)transactions / ITERATIONS,
+         (double)bytes / ITERATIONS);
+  for (uint8_t c = 0; c < bus.numClocks; c++)
+    printf(" %7.1fus", (double)bits * 1e6 / bus.clocks[c] / ITERATIONS);
+  printf("\n");
+}
+
+static void none(uint16_t) {}
+
+static void run(const Bus &bus, Adafruit_LIS3DH &lis, LIS3DH_Sim &sim) {
+  header(bus);
+  sensors_event_t event;
+  sensors_event_t events[LIS3DH_FIFO_SIZE];
+  lis3dh_sample_t samples[LIS3DH_FIFO_SIZE];
+  int32_t mg[3];
+  int16_t adc[3];
+
+  // a new sample before each call, so the data paths do their full work
+  auto next_sample = [&](uint16_t) { delayMicroseconds(2500); };
+  // about 25 samples waiting in the FIFO before each drain
+  auto fill_fifo = [&](uint16_t) { delay(63); };
+
+  bench(bus, sim, "read()", next_sample, [&](uint16_t) { lis.read(); });
+  bench(bus, sim, "readIfNew()", next_sample,
+        [&](uint16_t) { lis.readIfNew(); });
+  bench(bus, sim, "readMilliG()", next_sample,
+        [&](uint16_t) { lis.readMilliG(&mg[0], &mg[1], &mg[2]); });
+  bench(bus, sim, "getEvent()", next_sample,
+        [&](uint16_t) { lis.getEvent(&event); });
+  bench(bus, sim, "haveNewData()", none,
+        [&](uint16_t) { lis.haveNewData(); });
+  bench(bus, sim, "readADC(1)", none, [&](uint16_t) { lis.readADC(1); });
+  bench(bus, sim, "readADCs()", none,
+        [&](uint16_t) { lis.readADCs(&adc[0], &adc[1], &adc[2]); });
+  bench(bus, sim, "getClick()", none, [&](uint16_t) { lis.getClick(); });
+  // alternate between two settings so every call writes
+  bench(bus, sim, "setClick()", none,
+        [&](uint16_t i) { lis.setClick(2, (i & 1) ? 80 : 40); });
+  bench(bus, sim, "getRange()", none, [&](uint16_t) { lis.getRange(); });
+
+  lis.setFIFOMode(LIS3DH_FIFO_STREAM);
+  lis.readFIFO(samples);
+  bench(bus, sim, "readFIFO(), ~25 samples", fill_fifo,
+        [&](uint16_t) { lis.readFIFO(samples); });
+  bench(bus, sim, "getEvents(), ~25 samples", fill_fifo,
+        [&](uint16_t) { lis.getEvents(events, LIS3DH_FIFO_SIZE); });
+  bench(bus, sim, "getFIFOCount()", none,
+        [&](uint16_t) { lis.getFIFOCount(); });
+  lis.setFIFOMode(LIS3DH_FIFO_BYPASS);
+}
+
+int main(void) {
+  printf("LIS3DH bus cost per call, averaged over %d calls", ITERATIONS);
+
+  {
+    LIS3DH_Sim sim;
+    sim.attachI2C(0x18);
+    Adafruit_LIS3DH lis;
+    if (!lis.begin(0x18))
+      return 1;
+    Bus bus = {"I2C", false, i2c_clocks, 3};
+    run(bus, lis, sim);
+  }
+
+  {
+    LIS3DH_Sim sim;
+    sim.attachSPI(10);
+    Adafruit_LIS3DH lis(10);
+    if (!lis.begin())
+      return 1;
+    Bus bus = {"SPI", true, spi_clocks, 3};
+    run(bus, lis, sim);
+  }
+  return 0;
+}
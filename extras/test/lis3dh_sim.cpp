@@ -0,0 +1,433 @@
+/*!
+ *  @file lis3dh_sim.cpp
+ *
+ *  Register level LIS3DH simulator, plus the host Arduino core and BusIO
+ *  stand-ins that route bus traffic to it.
+ */
+
+#include "lis3dh_sim.h"
+
+TwoWire Wire;
+SPIClass SPI;
+
+static uint32_t sim_time_us = 0;
+static uint64_t sim_elapsed_us = 0; // doesn't wrap, for millis()
+static LIS3DH_Sim *sim_i2c[128];
+static LIS3DH_Sim *sim_spi[128];
+
+unsigned long micros(void) { return sim_time_us; }
+unsigned long millis(void) { return (unsigned long)(sim_elapsed_us / 1000); }
+void delay(unsigned long ms) { LIS3DH_Sim::advance(ms * 1000); }
+void delayMicroseconds(unsigned int us) { LIS3DH_Sim::advance(us); }
+void yield(void) {}
+void noInterrupts(void) {}
+void interrupts(void) {}
+
+LIS3DH_Sim::LIS3DH_Sim(void) {
+  memset(_regs, 0, sizeof(_regs));
+  memset(_out, 0, sizeof(_out));
+  _regs[LIS3DH_REG_WHOAMI] = 0x33;
+  _regs[0x1E] = 0x10; // CTRL_REG0
+  _regs[LIS3DH_REG_CTRL1] = 0x07;
+  _regs[LIS3DH_REG_FIFOSRC] = 0x20; // EMPTY
+}
+
+LIS3DH_Sim::~LIS3DH_Sim(void) {
+  if (_i2c >= 0)
+    sim_i2c[_i2c] = NULL;
+  if (_cs >= 0)
+    sim_spi[_cs] = NULL;
+}
+
+void LIS3DH_Sim::attachI2C(uint8_t addr) {
+  _i2c = addr & 0x7F;
+  sim_i2c[_i2c] = this;
+}
+
+void LIS3DH_Sim::attachSPI(int8_t cs) {
+  _cs = cs & 0x7F;
+  sim_spi[_cs] = this;
+}
+
+LIS3DH_Sim *LIS3DH_Sim::atI2C(uint8_t addr) { return sim_i2c[addr & 0x7F]; }
+
+LIS3DH_Sim *LIS3DH_Sim::atSPI(int8_t cs) {
+  return (cs < 0) ? NULL : sim_spi[cs & 0x7F];
+}
+
+uint32_t LIS3DH_Sim::now(void) { return sim_time_us; }
+
+/*!
+ *  Moves simulated time forward, producing samples on every attached sensor
+ */
+void LIS3DH_Sim::advance(uint32_t us) {
+  sim_time_us += us;
+  sim_elapsed_us += us;
+  for (uint8_t i = 0; i < 128; i++) {
+    if (sim_i2c[i])
+      sim_i2c[i]->update();
+    if (sim_spi[i])
+      sim_spi[i]->update();
+  }
+}
+
+void LIS3DH_Sim::setSample(int16_t x, int16_t y, int16_t z) {
+  _sample[0] = x;
+  _sample[1] = y;
+  _sample[2] = z;
+}
+
+/*!
+ *  With ramp on, sample n is (n, -n, 1000 + n), so order and loss show up
+ */
+void LIS3DH_Sim::setRamp(bool ramp) { _ramp = ramp; }
+
+void LIS3DH_Sim::fireInterrupt(uint8_t generator) {
+  uint8_t src = (generator == 2) ? LIS3DH_REG_INT2SRC : LIS3DH_REG_INT1SRC;
+  _regs[src] = 0x40 | 0x20; // IA, ZH
+  firedAt = generated;
+  checkTrigger();
+}
+
+/*!
+ *  Fires an interrupt generator once simulated time reaches at_us, between
+ *  the samples either side of it, so blocking driver calls can be tested
+ */
+void LIS3DH_Sim::scheduleInterrupt(uint8_t generator, uint32_t at_us) {
+  _pending = generator;
+  _pendingAt = at_us;
+}
+
+void LIS3DH_Sim::tap(uint8_t click_src) {
+  _regs[LIS3DH_REG_CLICKSRC] = click_src | 0x40; // IA
+  checkTrigger();
+}
+
+uint8_t LIS3DH_Sim::reg(uint8_t addr) const { return _regs[addr & 0x7F]; }
+
+void LIS3DH_Sim::setReg(uint8_t addr, uint8_t value) {
+  _regs[addr & 0x7F] = value;
+}
+
+uint8_t LIS3DH_Sim::fifoLevel(void) const { return _fifoLevel; }
+
+bool LIS3DH_Sim::triggered(void) const { return _triggered; }
+
+/*!
+ *  Level of the INT1 or INT2 pin, from the sources routed to it
+ */
+bool LIS3DH_Sim::pin(uint8_t int_pin) const {
+  bool click = _regs[LIS3DH_REG_CLICKSRC] & 0x40;
+  bool ia1 = _regs[LIS3DH_REG_INT1SRC] & 0x40;
+  bool ia2 = _regs[LIS3DH_REG_INT2SRC] & 0x40;
+  if (int_pin == 2) {
+    uint8_t ctrl6 = _regs[LIS3DH_REG_CTRL6];
+    return ((ctrl6 & 0x80) && click) || ((ctrl6 & 0x40) && ia1) ||
+           ((ctrl6 & 0x20) && ia2);
+  }
+  uint8_t ctrl3 = _regs[LIS3DH_REG_CTRL3];
+  uint8_t wtm = _regs[LIS3DH_REG_FIFOCTRL] & 0x1F;
+  return ((ctrl3 & 0x80) && click) || ((ctrl3 & 0x40) && ia1) ||
+         ((ctrl3 & 0x20) && ia2) ||
+         ((ctrl3 & 0x10) && (_regs[LIS3DH_REG_STATUS2] & 0x08)) ||
+         ((ctrl3 & 0x04) && (_fifoLevel > wtm)) ||
+         ((ctrl3 & 0x02) && (_fifoLevel == LIS3DH_FIFO_SIZE));
+}
+
+bool LIS3DH_Sim::fifoActive(void) const {
+  return (_regs[LIS3DH_REG_CTRL5] & 0x40) &&
+         (_regs[LIS3DH_REG_FIFOCTRL] & 0xC0);
+}
+
+/*!
+ *  Sample period in microseconds for the ODR in CTRL_REG1, 0 if powered down
+ */
+uint32_t LIS3DH_Sim::period(void) const {
+  static const uint32_t periods[16] = {0,    1000000, 100000, 40000,
+                                       20000, 10000,  5000,   2500,
+                                       625,   186,    0,      0,
+                                       0,     0,      0,      0};
+  uint8_t ctrl1 = _regs[LIS3DH_REG_CTRL1];
+  uint8_t odr = ctrl1 >> 4;
+  if ((odr == 9) && !(ctrl1 & 0x08)) // 1.344kHz unless low power
+    return 744;
+  return periods[odr];
+}
+
+void LIS3DH_Sim::update(void) {
+  uint32_t p = period();
+  if (p == 0)
+    _nextSample = sim_time_us;
+  while ((p != 0) && ((int32_t)(sim_time_us - _nextSample) >= 0)) {
+    if (_pending && ((int32_t)(_nextSample - _pendingAt) >= 0)) {
+      fireInterrupt(_pending);
+      _pending = 0;
+    }
+    generate();
+    _nextSample += p;
+  }
+  if (_pending && ((int32_t)(sim_time_us - _pendingAt) >= 0)) {
+    fireInterrupt(_pending);
+    _pending = 0;
+  }
+}
+
+void LIS3DH_Sim::checkTrigger(void) {
+  uint8_t fifo_ctrl = _regs[LIS3DH_REG_FIFOCTRL];
+  if (_triggered || ((fifo_ctrl & 0xC0) != 0xC0) ||
+      !(_regs[LIS3DH_REG_CTRL5] & 0x40))
+    return;
+  if (pin((fifo_ctrl & 0x20) ? 2 : 1)) // TR
+    _triggered = true;
+}
+
+void LIS3DH_Sim::generate(void) {
+  int16_t s[3];
+  if (_ramp) {
+    s[0] = (int16_t)generated;
+    s[1] = (int16_t)-generated;
+    s[2] = (int16_t)(1000 + generated);
+  } else {
+    memcpy(s, _sample, sizeof(s));
+  }
+  generated++;
+
+  uint8_t *status = &_regs[LIS3DH_REG_STATUS2];
+  if (*status & 0x08)
+    *status |= 0x80; // ZYXOR
+  *status |= 0x08;   // ZYXDA
+  memcpy(_out, s, sizeof(s));
+
+  checkTrigger();
+  if (fifoActive()) {
+    uint8_t mode = _regs[LIS3DH_REG_FIFOCTRL] >> 6;
+    // trigger mode streams until the trigger, then behaves as FIFO mode
+    bool stream = (mode == 2) || ((mode == 3) && !_triggered);
+    if (_fifoLevel == LIS3DH_FIFO_SIZE) {
+      if (!stream)
+        return; // FIFO mode stops collecting when full
+      _fifoHead = (_fifoHead + 1) % LIS3DH_FIFO_SIZE;
+      _fifoLevel--;
+    }
+    uint8_t slot = (_fifoHead + _fifoLevel) % LIS3DH_FIFO_SIZE;
+    memcpy(_fifo[slot], s, sizeof(s));
+    _fifoLevel++;
+  }
+}
+
+uint8_t LIS3DH_Sim::nextAddress(uint8_t addr) const {
+  // with the FIFO on, reads wrap from OUT_Z_H back to OUT_X_L
+  if ((addr == LIS3DH_REG_OUT_Z_H) && fifoActive())
+    return LIS3DH_REG_OUT_X_L;
+  return (addr + 1) & 0x7F;
+}
+
+uint8_t LIS3DH_Sim::readByte(uint8_t addr) {
+  if ((addr >= LIS3DH_REG_OUT_X_L) && (addr <= LIS3DH_REG_OUT_Z_H)) {
+    uint8_t index = addr - LIS3DH_REG_OUT_X_L;
+    const int16_t *s = _out;
+    if (fifoActive() && _fifoLevel)
+      s = _fifo[_fifoHead];
+    uint16_t v = (uint16_t)s[index / 2];
+    bool high = index & 1;
+    if (_regs[LIS3DH_REG_CTRL4] & 0x40) // BLE swaps the byte order
+      high = !high;
+    uint8_t value = high ? (v >> 8) : (v & 0xFF);
+    if (addr == LIS3DH_REG_OUT_Z_H) {
+      _regs[LIS3DH_REG_STATUS2] &= ~0x88; // ZYXOR, ZYXDA
+      if (fifoActive() && _fifoLevel) {
+        _fifoHead = (_fifoHead + 1) % LIS3DH_FIFO_SIZE;
+        _fifoLevel--;
+      }
+    }
+    return value;
+  }
+
+  if (addr == LIS3DH_REG_FIFOSRC) {
+    uint8_t wtm = _regs[LIS3DH_REG_FIFOCTRL] & 0x1F;
+    uint8_t src = _fifoLevel & 0x1F;
+    if (_fifoLevel > wtm)
+      src |= 0x80; // WTM
+    if (_fifoLevel == LIS3DH_FIFO_SIZE)
+      src |= 0x40; // OVRN_FIFO
+    if (_fifoLevel == 0)
+      src |= 0x20; // EMPTY
+    return src;
+  }
+
+  uint8_t value = _regs[addr];
+  // interrupt sources clear when read
+  if ((addr == LIS3DH_REG_INT1SRC) || (addr == LIS3DH_REG_INT2SRC) ||
+      (addr == LIS3DH_REG_CLICKSRC))
+    _regs[addr] = 0;
+  return value;
+}
+
+void LIS3DH_Sim::writeByte(uint8_t addr, uint8_t value) {
+  bool writable = ((addr >= 0x1E) && (addr <= 0x26)) ||
+                  (addr == LIS3DH_REG_FIFOCTRL) ||
+                  (addr == LIS3DH_REG_INT1CFG) || (addr == 0x32) ||
+                  (addr == 0x33) || (addr == LIS3DH_REG_INT2CFG) ||
+                  (addr == 0x36) || (addr == 0x37) ||
+                  (addr == LIS3DH_REG_CLICKCFG) ||
+                  ((addr >= LIS3DH_REG_CLICKTHS) && (addr <= 0x3F));
+  if (!writable) {
+    protocolErrors++;
+    return;
+  }
+
+  if (addr == LIS3DH_REG_CTRL1) {
+    // restart the sample clock at the new rate
+    _regs[addr] = value;
+    _nextSample = sim_time_us + period();
+    return;
+  }
+  if (addr == LIS3DH_REG_CTRL5)
+    value &= ~0x80; // BOOT clears itself
+  _regs[addr] = value;
+
+  // bypass mode, or turning the FIFO off, empties it and re-arms the trigger
+  if (((addr == LIS3DH_REG_FIFOCTRL) && !(value & 0xC0)) ||
+      ((addr == LIS3DH_REG_CTRL5) && !(value & 0x40))) {
+    _fifoLevel = 0;
+    _fifoHead = 0;
+    _triggered = false;
+  }
+}
+
+/*!
+ *  One read transaction. I2C sets bit 7 for auto-increment; SPI sets bit 7
+ *  for read and bit 6 for auto-increment.
+ */
+bool LIS3DH_Sim::busRead(uint8_t address, uint8_t *buffer, size_t len,
+                         bool spi) {
+  transactions++;
+  reads++;
+  bytes += len;
+  if (spi && !(address & 0x80))
+    protocolErrors++;
+  bool increment = spi ? (address & 0x40) : (address & 0x80);
+  uint8_t addr = address & (spi ? 0x3F : 0x7F);
+  for (size_t i = 0; i < len; i++) {
+    buffer[i] = readByte(addr);
+    if (increment)
+      addr = nextAddress(addr);
+  }
+  advance((len + 1) * (spi ? 16 : 25));
+  return true;
+}
+
+/*!
+ *  One write transaction, with the same address bits as busRead() except
+ *  that SPI writes clear bit 7
+ */
+bool LIS3DH_Sim::busWrite(uint8_t address, const uint8_t *buffer, size_t len,
+                          bool spi) {
+  transactions++;
+  bytes += len;
+  if (spi && (address & 0x80))
+    protocolErrors++;
+  bool increment = spi ? (address & 0x40) : (address & 0x80);
+  uint8_t addr = address & (spi ? 0x3F : 0x7F);
+  for (size_t i = 0; i < len; i++) {
+    writeByte(addr, buffer[i]);
+    if (increment)
+      addr = (addr + 1) & 0x7F;
+  }
+  advance((len + 1) * (spi ? 16 : 25));
+  return true;
+}
+
+Adafruit_I2CDevice::Adafruit_I2CDevice(uint8_t addr, TwoWire *theWire)
+    : _addr(addr), _wire(theWire) {}
+
+uint8_t Adafruit_I2CDevice::address(void) { return _addr; }
+
+bool Adafruit_I2CDevice::begin(bool addr_detect) {
+  return !addr_detect || detected();
+}
+
+bool Adafruit_I2CDevice::detected(void) {
+  return LIS3DH_Sim::atI2C(_addr) != NULL;
+}
+
+bool Adafruit_I2CDevice::read(uint8_t *buffer, size_t len, bool stop) {
+  (void)buffer;
+  (void)len;
+  (void)stop;
+  return false; // the LIS3DH always needs a register address first
+}
+
+bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
+                               const uint8_t *prefix_buffer,
+                               size_t prefix_len) {
+  (void)stop;
+  LIS3DH_Sim *sim = LIS3DH_Sim::atI2C(_addr);
+  if (!sim)
+    return false;
+  if (prefix_len == 1)
+    return sim->busWrite(prefix_buffer[0], buffer, len, false);
+  if ((prefix_len == 0) && (len > 0))
+    return sim->busWrite(buffer[0], buffer + 1, len - 1, false);
+  return false;
+}
+
+bool Adafruit_I2CDevice::write_then_read(const uint8_t *write_buffer,
+                                         size_t write_len,
+                                         uint8_t *read_buffer,
+                                         size_t read_len, bool stop) {
+  (void)stop;
+  LIS3DH_Sim *sim = LIS3DH_Sim::atI2C(_addr);
+  if (!sim || (write_len != 1) || (read_len > maxBufferSize()))
+    return false;
+  return sim->busRead(write_buffer[0], read_buffer, read_len, false);
+}
+
+size_t Adafruit_I2CDevice::maxBufferSize(void) { return 32; }
+
+Adafruit_SPIDevice::Adafruit_SPIDevice(int8_t cspin, uint32_t freq,
+                                       BusIOBitOrder dataOrder,
+                                       uint8_t dataMode, SPIClass *theSPI)
+    : _cs(cspin), _setting(new uint8_t[4]) {
+  (void)freq;
+  (void)dataOrder;
+  (void)dataMode;
+  (void)theSPI;
+}
+
+Adafruit_SPIDevice::Adafruit_SPIDevice(int8_t cspin, int8_t sck, int8_t miso,
+                                       int8_t mosi, uint32_t freq,
+                                       BusIOBitOrder dataOrder,
+                                       uint8_t dataMode)
+    : _cs(cspin), _setting(new uint8_t[4]) {
+  (void)sck;
+  (void)miso;
+  (void)mosi;
+  (void)freq;
+  (void)dataOrder;
+  (void)dataMode;
+}
+
+Adafruit_SPIDevice::~Adafruit_SPIDevice(void) { delete[] _setting; }
+
+bool Adafruit_SPIDevice::begin(void) { return true; }
+
+bool Adafruit_SPIDevice::write(const uint8_t *buffer, size_t len,
+                               const uint8_t *prefix_buffer,
+                               size_t prefix_len) {
+  LIS3DH_Sim *sim = LIS3DH_Sim::atSPI(_cs);
+  if (!sim || (prefix_len != 1))
+    return false;
+  return sim->busWrite(prefix_buffer[0], buffer, len, true);
+}
+
+bool Adafruit_SPIDevice::write_then_read(const uint8_t *write_buffer,
+                                         size_t write_len,
+                                         uint8_t *read_buffer,
+                                         size_t read_len, uint8_t sendvalue) {
+  (void)sendvalue;
+  LIS3DH_Sim *sim = LIS3DH_Sim::atSPI(_cs);
+  if (!sim || (write_len != 1))
+    return false;
+  return sim->busRead(write_buffer[0], read_buffer, read_len, true);
+}
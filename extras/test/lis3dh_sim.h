@@ -0,0 +1,84 @@
+/*!
+ *  @file lis3dh_sim.h
+ *
+ *  Register level LIS3DH simulator for building and testing the driver on a
+ *  host. The stub Adafruit_I2CDevice / Adafruit_SPIDevice in stubs/ forward
+ *  every transaction to the simulator attached at their I2C address or chip
+ *  select, so the real driver code runs unchanged.
+ *
+ *  Modelled: the register map, I2C (0x80) and SPI (0x40 | 0x80 read)
+ *  auto-increment, OUT_X_L - OUT_Z_H wrap-around with the FIFO enabled,
+ *  ODR paced sample generation, BLE byte order, STATUS_REG overrun, the
+ *  FIFO modes (including trigger mode and FIFO overrun), clear-on-read
+ *  interrupt sources and the INT1/INT2 pin signals.
+ */
+
+#ifndef LIS3DH_SIM_H
+#define LIS3DH_SIM_H
+
+#include <Adafruit_LIS3DH.h>
+
+/*!
+ *  @brief  One simulated LIS3DH
+ */
+class LIS3DH_Sim {
+public:
+  LIS3DH_Sim(void);
+  ~LIS3DH_Sim(void);
+
+  void attachI2C(uint8_t addr);
+  void attachSPI(int8_t cs);
+
+  void setSample(int16_t x, int16_t y, int16_t z);
+  void setRamp(bool ramp);
+  void fireInterrupt(uint8_t generator);
+  void scheduleInterrupt(uint8_t generator, uint32_t at_us);
+  void tap(uint8_t click_src);
+
+  uint8_t reg(uint8_t addr) const;
+  void setReg(uint8_t addr, uint8_t value);
+  bool pin(uint8_t int_pin) const;
+  uint8_t fifoLevel(void) const;
+  bool triggered(void) const;
+
+  bool busRead(uint8_t address, uint8_t *buffer, size_t len, bool spi);
+  bool busWrite(uint8_t address, const uint8_t *buffer, size_t len, bool spi);
+
+  static LIS3DH_Sim *atI2C(uint8_t addr);
+  static LIS3DH_Sim *atSPI(int8_t cs);
+  static void advance(uint32_t us);
+  static uint32_t now(void);
+
+  uint32_t transactions = 0;   ///< bus transactions seen
+  uint32_t reads = 0;          ///< of which were reads
+  uint32_t bytes = 0;          ///< data bytes transferred
+  uint32_t protocolErrors = 0; ///< bad address bits or read-only writes
+  uint32_t generated = 0;      ///< samples produced at the ODR
+  uint32_t firedAt = 0;        ///< samples produced before the last event
+
+private:
+  void update(void);
+  void generate(void);
+  void checkTrigger(void);
+  uint32_t period(void) const;
+  uint8_t readByte(uint8_t addr);
+  void writeByte(uint8_t addr, uint8_t value);
+  uint8_t nextAddress(uint8_t addr) const;
+  bool fifoActive(void) const;
+
+  uint8_t _regs[128];
+  int16_t _out[3];
+  int16_t _fifo[LIS3DH_FIFO_SIZE][3];
+  uint8_t _fifoHead = 0;
+  uint8_t _fifoLevel = 0;
+  bool _triggered = false;
+  int16_t _sample[3] = {0, 0, 0};
+  bool _ramp = false;
+  uint32_t _nextSample = 0;
+  uint8_t _pending = 0;
+  uint32_t _pendingAt = 0;
+  int16_t _i2c = -1;
+  int8_t _cs = -1;
+};
+
+#endif
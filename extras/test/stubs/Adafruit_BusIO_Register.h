@@ -0,0 +1,14 @@
+/*!
+ *  @file Adafruit_BusIO_Register.h
+ *
+ *  Host stand-in for Adafruit BusIO; the driver only needs the device
+ *  classes
+ */
+
+#ifndef LIS3DH_TEST_BUSIO_REGISTER_H
+#define LIS3DH_TEST_BUSIO_REGISTER_H
+
+#include <Adafruit_I2CDevice.h>
+#include <Adafruit_SPIDevice.h>
+
+#endif
@@ -0,0 +1,35 @@
+/*!
+ *  @file Adafruit_I2CDevice.h
+ *
+ *  Host stand-in for Adafruit BusIO's I2C device, forwarding every
+ *  transaction to the simulated LIS3DH at the device's address
+ */
+
+#ifndef LIS3DH_TEST_I2CDEVICE_H
+#define LIS3DH_TEST_I2CDEVICE_H
+
+#include <Wire.h>
+
+/*!
+ *  @brief  I2C device with the same interface as Adafruit BusIO's
+ */
+class Adafruit_I2CDevice {
+public:
+  Adafruit_I2CDevice(uint8_t addr, TwoWire *theWire = &Wire);
+  uint8_t address(void);
+  bool begin(bool addr_detect = true);
+  bool detected(void);
+  bool read(uint8_t *buffer, size_t len, bool stop = true);
+  bool write(const uint8_t *buffer, size_t len, bool stop = true,
+             const uint8_t *prefix_buffer = nullptr, size_t prefix_len = 0);
+  bool write_then_read(const uint8_t *write_buffer, size_t write_len,
+                       uint8_t *read_buffer, size_t read_len,
+                       bool stop = false);
+  size_t maxBufferSize(void);
+
+private:
+  uint8_t _addr;
+  TwoWire *_wire;
+};
+
+#endif
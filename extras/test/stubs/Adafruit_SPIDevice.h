@@ -0,0 +1,46 @@
+/*!
+ *  @file Adafruit_SPIDevice.h
+ *
+ *  Host stand-in for Adafruit BusIO's SPI device, forwarding every
+ *  transaction to the simulated LIS3DH on the device's chip select
+ */
+
+#ifndef LIS3DH_TEST_SPIDEVICE_H
+#define LIS3DH_TEST_SPIDEVICE_H
+
+#include <SPI.h>
+
+/*! Bit order, as in Adafruit BusIO */
+typedef enum _BitOrder {
+  SPI_BITORDER_MSBFIRST = MSBFIRST,
+  SPI_BITORDER_LSBFIRST = LSBFIRST,
+} BusIOBitOrder;
+
+/*!
+ *  @brief  SPI device with the same interface as Adafruit BusIO's
+ */
+class Adafruit_SPIDevice {
+public:
+  Adafruit_SPIDevice(int8_t cspin, uint32_t freq = 1000000,
+                     BusIOBitOrder dataOrder = SPI_BITORDER_MSBFIRST,
+                     uint8_t dataMode = SPI_MODE0, SPIClass *theSPI = &SPI);
+  Adafruit_SPIDevice(int8_t cspin, int8_t sck, int8_t miso, int8_t mosi,
+                     uint32_t freq = 1000000,
+                     BusIOBitOrder dataOrder = SPI_BITORDER_MSBFIRST,
+                     uint8_t dataMode = SPI_MODE0);
+  ~Adafruit_SPIDevice(void);
+
+  bool begin(void);
+  bool write(const uint8_t *buffer, size_t len,
+             const uint8_t *prefix_buffer = nullptr, size_t prefix_len = 0);
+  bool write_then_read(const uint8_t *write_buffer, size_t write_len,
+                       uint8_t *read_buffer, size_t read_len,
+                       uint8_t sendvalue = 0xFF);
+
+private:
+  int8_t _cs;
+  uint8_t *_setting; // heap allocated like BusIO's SPISettings, so a double
+                     // destroy shows up under a sanitizer
+};
+
+#endif
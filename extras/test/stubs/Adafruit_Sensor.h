@@ -0,0 +1,79 @@
+/*!
+ *  @file Adafruit_Sensor.h
+ *
+ *  Host stand-in for the Adafruit Unified Sensor types used by the driver
+ */
+
+#ifndef LIS3DH_TEST_SENSOR_H
+#define LIS3DH_TEST_SENSOR_H
+
+#include <stdint.h>
+
+#define SENSORS_GRAVITY_STANDARD (9.80665F) ///< Earth's gravity in m/s^2
+
+/*! Sensor types */
+typedef enum {
+  SENSOR_TYPE_ACCELEROMETER = (1),
+} sensors_type_t;
+
+/*! x/y/z vector */
+typedef struct {
+  union {
+    float v[3]; ///< as an array
+    struct {
+      float x; ///< x component
+      float y; ///< y component
+      float z; ///< z component
+    };
+  };
+  int8_t status;       ///< status
+  uint8_t reserved[3]; ///< padding
+} sensors_vec_t;
+
+/*! Sensor event */
+typedef struct {
+  int32_t version;   ///< sizeof(sensors_event_t)
+  int32_t sensor_id; ///< sensor identifier
+  int32_t type;      ///< sensor type
+  int32_t reserved0; ///< reserved
+  int32_t timestamp; ///< time in milliseconds
+  union {
+    float data[4];              ///< raw data
+    sensors_vec_t acceleration; ///< acceleration in m/s^2
+  };
+} sensors_event_t;
+
+/*! Sensor details */
+typedef struct {
+  char name[12];     ///< sensor name
+  int32_t version;   ///< version of the hardware and driver
+  int32_t sensor_id; ///< sensor identifier
+  int32_t type;      ///< sensor type
+  float max_value;   ///< maximum value
+  float min_value;   ///< minimum value
+  float resolution;  ///< smallest difference between values
+  int32_t min_delay; ///< minimum delay between events in microseconds
+} sensor_t;
+
+/*!
+ *  @brief  Unified sensor base class
+ */
+class Adafruit_Sensor {
+public:
+  virtual ~Adafruit_Sensor() {}
+  /*!
+   *  @brief  Gets the latest event
+   *  @param  event
+   *          event to fill
+   *  @return true if successful
+   */
+  virtual bool getEvent(sensors_event_t *event) = 0;
+  /*!
+   *  @brief  Gets the sensor details
+   *  @param  sensor
+   *          details to fill
+   */
+  virtual void getSensor(sensor_t *sensor) = 0;
+};
+
+#endif
@@ -0,0 +1,28 @@
+/*!
+ *  @file Arduino.h
+ *
+ *  Minimal host stand-in for the Arduino core, just enough to build the
+ *  LIS3DH driver against the simulator in lis3dh_sim.h. Time is simulated:
+ *  micros() only moves when delay() is called or bus traffic happens.
+ */
+
+#ifndef LIS3DH_TEST_ARDUINO_H
+#define LIS3DH_TEST_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+void noInterrupts(void);
+void interrupts(void);
+
+#endif
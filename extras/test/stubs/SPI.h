@@ -0,0 +1,25 @@
+/*!
+ *  @file SPI.h
+ *
+ *  Host stand-in for the Arduino SPI library
+ */
+
+#ifndef LIS3DH_TEST_SPI_H
+#define LIS3DH_TEST_SPI_H
+
+#include "Arduino.h"
+
+#define SPI_MODE0 0x00 ///< CPOL 0, CPHA 0
+
+/*!
+ *  @brief  Placeholder SPI bus, the simulator does the real work
+ */
+class SPIClass {
+public:
+  /*! @brief  Starts the bus */
+  void begin(void) {}
+};
+
+extern SPIClass SPI; ///< Default SPI bus
+
+#endif
@@ -0,0 +1,29 @@
+/*!
+ *  @file Wire.h
+ *
+ *  Host stand-in for the Arduino Wire library
+ */
+
+#ifndef LIS3DH_TEST_WIRE_H
+#define LIS3DH_TEST_WIRE_H
+
+#include "Arduino.h"
+
+/*!
+ *  @brief  Placeholder I2C bus, the simulator does the real work
+ */
+class TwoWire {
+public:
+  /*! @brief  Starts the bus */
+  void begin(void) {}
+  /*!
+   *  @brief  Sets the bus clock
+   *  @param  clock
+   *          frequency in Hz
+   */
+  void setClock(uint32_t clock) { (void)clock; }
+};
+
+extern TwoWire Wire; ///< Default I2C bus
+
+#endif
@@ -0,0 +1,644 @@
+/*!
+ *  @file test_lis3dh.cpp
+ *
+ *  Host tests for the LIS3DH driver, run against the register level
+ *  simulator in lis3dh_sim.h. Build and run with `make` in this directory.
+ */
+
+#include <stdio.h>
+
+#include "lis3dh_sim.h"
+#include <Adafruit_LIS3DH_Filter.h>
+#include <Adafruit_LIS3DH_Group.h>
+#include <Adafruit_LIS3DH_Lite.h>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);        \
+      failures++;                                                              \
+    }                                                                          \
+  } while (0)
+
+#define CHECK_NEAR(a, b, tol) CHECK(fabs((double)(a) - (double)(b)) <= (tol))
+
+#define RUN(test)                                                              \
+  do {                                                                         \
+    printf("%s\n", #test);                                                     \
+    test();                                                                    \
+  } while (0)
+
+static void test_begin_defaults(void) {
+  LIS3DH_Sim sim;
+  sim.attachI2C(0x18);
+  Adafruit_LIS3DH lis;
+  CHECK(lis.begin(0x18));
+  CHECK(sim.reg(LIS3DH_REG_CTRL1) == 0x77); // 400Hz, all axes
+  CHECK(sim.reg(LIS3DH_REG_CTRL4) == 0x88); // BDU, high resolution, 2G
+  CHECK(sim.reg(LIS3DH_REG_CTRL3) == LIS3DH_INT1_DRDY1);
+  CHECK(sim.reg(LIS3DH_REG_TEMPCFG) == 0x80); // ADC on, temperature off
+  CHECK(lis.getRange() == LIS3DH_RANGE_2_G);
+  CHECK(lis.getDataRate() == LIS3DH_DATARATE_400_HZ);
+  CHECK(lis.getPerformanceMode() == LIS3DH_MODE_HIGH_RESOLUTION);
+  CHECK(sim.protocolErrors == 0);
+
+  // a sensor left big-endian and in self test, e.g. before a watchdog reset,
+  // comes out of begin() in the defaults too
+  sim.setReg(LIS3DH_REG_CTRL4, 0x40 | 0x02 | 0x01); // BLE, ST0, SIM
+  CHECK(lis.begin(0x18));
+  CHECK(sim.reg(LIS3DH_REG_CTRL4) == 0x88);
+  sim.setSample(16000, 0, 0);
+  delay(5);
+  lis.read();
+  CHECK(lis.x == 16000);
+}
+
+static void test_begin_failures(void) {
+  Adafruit_LIS3DH missing;
+  CHECK(!missing.begin(0x18)); // nothing attached
+
+  LIS3DH_Sim sim;
+  sim.attachI2C(0x19);
+  sim.setReg(LIS3DH_REG_WHOAMI, 0x44);
+  Adafruit_LIS3DH lis;
+  CHECK(!lis.begin(0x19));
+  CHECK(lis.begin(0x19, 0x44)); // and begin() can be called again
+}
+
+static void test_read_i2c(void) {
+  LIS3DH_Sim sim;
+  sim.attachI2C(0x18);
+  Adafruit_LIS3DH lis;
+  CHECK(lis.begin(0x18));
+
+  sim.setSample(16000, -8000, 0);
+  delay(5);
+  uint32_t before = sim.transactions;
+  lis.read();
+  CHECK(sim.transactions == before + 1); // one burst for all three axes
+  CHECK(lis.x == 16000);
+  CHECK(lis.y == -8000);
+  CHECK(lis.z == 0);
+  CHECK_NEAR(lis.x_g, 1.0, 1e-6);
+  CHECK_NEAR(lis.y_g, -0.5, 1e-6);
+
+  uint32_t start = LIS3DH_Sim::now();
+  lis.setRange(LIS3DH_RANGE_16_G);
+  CHECK((sim.reg(LIS3DH_REG_CTRL4) & 0x30) == 0x30);
+  CHECK(LIS3DH_Sim::now() - start >= 15000); // settles after a change
+  before = sim.transactions;
+  start = LIS3DH_Sim::now();
+  lis.setRange(LIS3DH_RANGE_16_G);
+  CHECK(sim.transactions == before); // but not when nothing changed
+  CHECK(LIS3DH_Sim::now() == start);
+  lis.read();
+  CHECK_NEAR(lis.x_g, 12.0, 1e-5); // 16G is 3x the 8G sensitivity
+
+  sensors_event_t event;
+  CHECK(lis.getEvent(&event));
+  CHECK_NEAR(event.acceleration.x, 12.0 * SENSORS_GRAVITY_STANDARD, 1e-3);
+}
+
+static void test_read_spi(void) {
+  LIS3DH_Sim sim;
+  sim.attachSPI(10);
+  Adafruit_LIS3DH lis(10);
+  CHECK(lis.begin());
+
+  sim.setSample(-16000, 4000, 32000);
+  delay(5);
+  lis.read();
+  CHECK(lis.x == -16000);
+  CHECK(lis.y == 4000);
+  CHECK(lis.z == 32000);
+  CHECK_NEAR(lis.x_g, -1.0, 1e-6);
+  CHECK(sim.protocolErrors == 0); // read / write / auto-increment bits
+}
+
+static void test_read_if_new(void) {
+  LIS3DH_Sim sim;
+  sim.attachI2C(0x18);
+  Adafruit_LIS3DH lis;
+  CHECK(lis.begin(0x18));
+
+  lis.read(); // consume the pending sample
+  bool overrun = true;
+  CHECK(!lis.readIfNew(&overrun));
+  uint8_t polls = 0;
+  while (!lis.readIfNew(&overrun) && (polls++ < 10))
+    delayMicroseconds(500);
+  CHECK(polls < 10);
+  CHECK(!overrun);
+  delay(6); // two periods, one sample overwritten
+  CHECK(lis.readIfNew(&overrun));
+  CHECK(overrun);
+}
+
+static void test_set_click(void) {
+  LIS3DH_Sim sim;
+  sim.attachI2C(0x18);
+  Adafruit_LIS3DH lis;
+  CHECK(lis.begin(0x18));
+
+  uint32_t before = sim.transactions;
+  lis.setClick(1, 80);
+  CHECK(sim.reg(LIS3DH_REG_CLICKCFG) == 0x15); // single tap, all axes
+  CHECK(sim.reg(LIS3DH_REG_CLICKTHS) == 80);
+  CHECK(sim.reg(LIS3DH_REG_TIMELIMIT) == 10);
+  CHECK(sim.reg(LIS3DH_REG_TIMELATENCY) == 20);
+  CHECK(sim.reg(LIS3DH_REG_TIMEWINDOW) == 255);
+  CHECK(sim.reg(LIS3DH_REG_CTRL3) & LIS3DH_INT1_CLICK);
+  CHECK(sim.reg(LIS3DH_REG_CTRL5) & 0x08); // LIR_INT1
+  // CTRL_REG3 + CTRL_REG5, CLICK_CFG, and CLICK_THS - TIME_WINDOW
+  CHECK(sim.transactions - before == 3);
+
+  sim.tap(0x10 | 0x04); // single click on Z
+  CHECK(sim.pin(1));
+  CHECK((lis.getClick() & 0x14) == 0x14);
+  CHECK(sim.reg(LIS3DH_REG_CLICKSRC) == 0); // reading it cleared it
+
+  lis.setClick(2, 40);
+  CHECK(sim.reg(LIS3DH_REG_CLICKCFG) == 0x2A); // double tap
+  lis.setClick(0, 0);
+  CHECK(sim.reg(LIS3DH_REG_CLICKCFG) == 0);
+  CHECK(!(sim.reg(LIS3DH_REG_CTRL3) & LIS3DH_INT1_CLICK));
+}
+
+static void test_tap_queue(void) {
+  LIS3DH_Sim sim;
+  sim.attachI2C(0x18);
+  Adafruit_LIS3DH lis;
+  CHECK(lis.begin(0x18));
+  lis.setTap(2, 1250);
+
+  sim.tap(0x20 | 0x08 | 0x04); // double tap, -Z
+  CHECK(!lis.collectTap());    // no queue yet
+  lis3dh_tap_t taps[3];
+  CHECK(!lis.setTapBuffer(taps, 1));
+  CHECK(lis.setTapBuffer(taps, 3));
+
+  // one slot is kept free, so a 3 slot queue holds two taps
+  sim.tap(0x20 | 0x08 | 0x04);
+  CHECK(lis.collectTap());
+  CHECK(!lis.collectTap()); // CLICK_SRC cleared on read
+  sim.tap(0x10 | 0x01);     // single tap, +X
+  CHECK(lis.collectTap());
+  sim.tap(0x10 | 0x02);
+  CHECK(!lis.collectTap()); // full
+  CHECK(lis.tapsAvailable() == 2);
+
+  lis3dh_tap_t tap;
+  CHECK(lis.popTap(&tap));
+  CHECK(tap.doubleTap && tap.negative && (tap.axes == 4));
+  CHECK(lis.popTap(&tap));
+  CHECK(!tap.doubleTap && !tap.negative && (tap.axes == 1));
+  CHECK(!lis.popTap(&tap));
+  CHECK(lis.tapsAvailable() == 0);
+}
+
+static void test_sample_ring(void) {
+  LIS3DH_Sim sim;
+  sim.attachI2C(0x18);
+  Adafruit_LIS3DH lis;
+  CHECK(lis.begin(0x18));
+  sim.setRamp(true);
+  CHECK(lis.collectSamples() == 0); // no buffer yet
+
+  lis3dh_sample_t ring[8];
+  CHECK(lis.setSampleBuffer(ring, 8));
+  lis.setFIFOMode(LIS3DH_FIFO_STREAM);
+  int16_t expect = (int16_t)sim.generated;
+  int16_t seen = 0;
+  // drain in uneven steps so the ring wraps around
+  for (uint8_t round = 0; round < 6; round++) {
+    delay(10);
+    lis.collectSamples();
+    CHECK(lis.samplesAvailable() <= 7);
+    lis3dh_sample_t sample;
+    for (uint8_t i = 0; (i < 3) && lis.popSample(&sample); i++, seen++)
+      CHECK(sample.x == expect++);
+  }
+  CHECK(seen == 18);
+}
+
+static void test_fifo_stream(void) {
+  LIS3DH_Sim sim;
+  sim.attachI2C(0x18);
+  Adafruit_LIS3DH lis;
+  CHECK(lis.begin(0x18));
+  sim.setRamp(true);
+  lis.setFIFOMode(LIS3DH_FIFO_STREAM);
+  uint32_t first = sim.generated;
+
+  delay(50); // 20 samples at 400Hz
+  lis3dh_sample_t samples[LIS3DH_FIFO_SIZE];
+  uint32_t before = sim.transactions;
+  uint8_t count = lis.readFIFO(samples, LIS3DH_FIFO_SIZE);
+  CHECK(count == 20);
+  // FIFO_SRC, then 32 byte I2C bursts of 5 samples
+  CHECK(sim.transactions - before == 1 + (count + 4) / 5u);
+  for (uint8_t i = 0; i < count; i++) {
+    CHECK(samples[i].x == (int16_t)(first + i));
+    CHECK(samples[i].y == (int16_t)-(first + i));
+    CHECK(samples[i].z == (int16_t)(1000 + first + i));
+  }
+  for (uint8_t i = 1; i < count; i++)
+    CHECK(samples[i].timestamp - samples[i - 1].timestamp == 2500);
+  CHECK(sim.protocolErrors == 0);
+}
+
+static void test_fifo_watermark(void) {
+  LIS3DH_Sim sim;
+  sim.attachSPI(7);
+  Adafruit_LIS3DH lis(7);
+  CHECK(lis.begin());
+  sim.setRamp(true);
+  lis3dh_sample_t samples[LIS3DH_FIFO_SIZE];
+
+  // WTM is raised once the FIFO holds more than the level
+  const uint8_t levels[] = {9, 0, 31};
+  for (uint8_t l = 0; l < sizeof(levels); l++) {
+    lis.setFIFOMode(LIS3DH_FIFO_BYPASS);
+    lis.setFIFOWatermark(levels[l]);
+    lis.setFIFOMode(LIS3DH_FIFO_STREAM);
+    while (sim.fifoLevel() <= levels[l])
+      delayMicroseconds(100);
+
+    // no FIFO_SRC read, and the newest sample is stamped as it is drained
+    uint32_t before = sim.transactions;
+    uint32_t drained = LIS3DH_Sim::now();
+    uint8_t count = lis.readFIFOWatermark(samples);
+    CHECK(count == levels[l] + 1);
+    CHECK(sim.transactions - before == 1);
+    CHECK(samples[count - 1].timestamp == drained);
+    // a long burst can outlast a sample period
+    CHECK(samples[count - 1].x ==
+          (int16_t)(sim.generated - 1 - sim.fifoLevel()));
+    for (uint8_t i = 1; i < count; i++)
+      CHECK(samples[i].x == samples[i - 1].x + 1);
+  }
+  CHECK(sim.protocolErrors == 0);
+}
+
+static void test_event_timestamps(void) {
+  LIS3DH_Sim sim;
+  sim.attachI2C(0x18);
+  Adafruit_LIS3DH lis;
+  CHECK(lis.begin(0x18));
+  sim.setRamp(true);
+
+  // run micros() past its 32 bit wrap; event timestamps follow millis()
+  delay(2147500); // in two steps, advance() takes 32 bit microseconds
+  delay(2147500);
+  CHECK(millis() > 0xFFFFFFFFUL / 1000);
+  sensors_event_t event;
+  int32_t before = millis();
+  CHECK(lis.getEvent(&event));
+  CHECK(event.timestamp >= before);
+  CHECK(event.timestamp <= (int32_t)millis());
+
+  lis.setFIFOMode(LIS3DH_FIFO_STREAM);
+  delay(25); // 10 samples at 400Hz
+  sensors_event_t events[LIS3DH_FIFO_SIZE];
+  size_t count = lis.getEvents(events, LIS3DH_FIFO_SIZE);
+  CHECK(count >= 9);
+  CHECK(events[count - 1].timestamp <= (int32_t)millis());
+  CHECK(events[count - 1].timestamp >= (int32_t)millis() - 3);
+  CHECK(events[0].timestamp > 4295000);
+  for (size_t i = 1; i < count; i++)
+    CHECK(events[i].timestamp >= events[i - 1].timestamp);
+}
+
+static void test_fifo_overrun(void) {
+  LIS3DH_Sim sim;
+  sim.attachSPI(9);
+  Adafruit_LIS3DH lis(9);
+  CHECK(lis.begin());
+  sim.setRamp(true);
+  lis.setFIFOMode(LIS3DH_FIFO_STREAM);
+  lis.resetStats();
+
+  delay(100); // 40 samples, the FIFO keeps the newest 32
+  CHECK(lis.getFIFOCount() == LIS3DH_FIFO_SIZE);
+  lis3dh_sample_t samples[LIS3DH_FIFO_SIZE];
+  uint8_t count = lis.readFIFO(samples, LIS3DH_FIFO_SIZE);
+  CHECK(count == LIS3DH_FIFO_SIZE);
+  for (uint8_t i = 1; i < count; i++)
+    CHECK(samples[i].x == samples[i - 1].x + 1);
+
+  lis3dh_stats_t stats;
+  lis.getStats(&stats);
+  CHECK(stats.fifoOverflows >= 1);
+  CHECK(stats.maxFIFOLevel == LIS3DH_FIFO_SIZE);
+  CHECK(sim.protocolErrors == 0);
+}
+
+static void test_capture_shock(void) {
+  LIS3DH_Sim sim;
+  sim.attachI2C(0x18);
+  Adafruit_LIS3DH lis;
+  CHECK(lis.begin(0x18)); // leaves DRDY1 routed to INT1
+  sim.setRamp(true);
+  CHECK(lis.setInterruptGenerator(1, LIS3DH_INT_OR, LIS3DH_INT_ZHIGH, 1500,
+                                  0, 1, true));
+  lis.resetStats();
+
+  // the FIFO must hold the samples leading up to the event, not freeze on
+  // the first data ready sharing the pin
+  sim.scheduleInterrupt(1, LIS3DH_Sim::now() + 200000);
+  lis3dh_sample_t samples[64];
+  uint8_t pre = 0;
+  uint16_t count = lis.captureShock(samples, 64, 1, 1000, &pre);
+  CHECK(pre == LIS3DH_FIFO_SIZE);
+  CHECK(count == 64);
+  CHECK(samples[pre - 1].x == (int16_t)(sim.firedAt - 1));
+  for (uint8_t i = 1; i < pre; i++)
+    CHECK(samples[i].x == samples[i - 1].x + 1);
+  CHECK(samples[pre].x >= samples[pre - 1].x + 1);
+  for (uint16_t i = pre + 1; i < count; i++)
+    CHECK(samples[i].x == samples[i - 1].x + 1);
+
+  // the frozen full FIFO is expected, and the INT1 routing is restored
+  lis3dh_stats_t stats;
+  lis.getStats(&stats);
+  CHECK(stats.fifoOverflows == 0);
+  CHECK(sim.reg(LIS3DH_REG_CTRL3) == (LIS3DH_INT1_DRDY1 | LIS3DH_INT1_IA1));
+  CHECK((sim.reg(LIS3DH_REG_FIFOCTRL) & 0xC0) == 0); // bypass, as before
+  CHECK(!(sim.reg(LIS3DH_REG_CTRL5) & 0x40));
+  CHECK(sim.protocolErrors == 0);
+
+  // and a timeout still restores it; a streaming FIFO keeps streaming
+  lis.setFIFOWatermark(12);
+  lis.setFIFOMode(LIS3DH_FIFO_STREAM);
+  CHECK(lis.captureShock(samples, 64, 1, 20, &pre) == 0);
+  CHECK(sim.reg(LIS3DH_REG_CTRL3) == (LIS3DH_INT1_DRDY1 | LIS3DH_INT1_IA1));
+  CHECK(sim.reg(LIS3DH_REG_FIFOCTRL) == ((LIS3DH_FIFO_STREAM << 6) | 12));
+  CHECK(sim.reg(LIS3DH_REG_CTRL5) & 0x40); // FIFO_EN
+  CHECK(lis.getFIFOMode() == LIS3DH_FIFO_STREAM);
+
+  // as does a capture that triggered
+  sim.scheduleInterrupt(1, LIS3DH_Sim::now() + 100000);
+  CHECK(lis.captureShock(samples, 64, 1, 1000, &pre) == 64);
+  CHECK(sim.reg(LIS3DH_REG_FIFOCTRL) == ((LIS3DH_FIFO_STREAM << 6) | 12));
+  CHECK(sim.reg(LIS3DH_REG_CTRL5) & 0x40);
+  delay(25);
+  CHECK(lis.getFIFOCount() >= 9);
+  CHECK(sim.protocolErrors == 0);
+}
+
+static uint16_t group_samples[2];
+
+static void count_batch(uint8_t index, const lis3dh_sample_t *samples,
+                        uint8_t count) {
+  (void)samples;
+  group_samples[index] += count;
+}
+
+static uint32_t group_clock(void) { return 42; }
+
+static void test_group(void) {
+  LIS3DH_Sim sim_a, sim_b;
+  sim_a.attachI2C(0x18);
+  sim_b.attachI2C(0x19);
+  Adafruit_LIS3DH a, b;
+  CHECK(a.begin(0x18));
+  CHECK(b.begin(0x19));
+  a.setFIFOMode(LIS3DH_FIFO_STREAM);
+  b.setFIFOMode(LIS3DH_FIFO_STREAM);
+
+  // a clock set on a sensor survives add() until the group sets one
+  a.setClockSource(group_clock);
+  Adafruit_LIS3DH_Group group(LIS3DH_SCHEDULE_FILL_LEVEL);
+  CHECK(group.add(&a) == 0);
+  CHECK(a.now() == 42);
+  group.setClockSource(NULL);
+  CHECK(a.now() != 42);
+  CHECK(group.add(&b) == 1);
+  group.setCallback(count_batch);
+
+  // both FIFOs overflow; each FIFO_SRC is read, and counted, once per poll
+  delay(100);
+  a.resetStats();
+  b.resetStats();
+  group_samples[0] = group_samples[1] = 0;
+  uint32_t before = sim_a.transactions + sim_b.transactions;
+  CHECK(group.poll() == 2 * LIS3DH_FIFO_SIZE);
+  CHECK(group_samples[0] == LIS3DH_FIFO_SIZE);
+  CHECK(group_samples[1] == LIS3DH_FIFO_SIZE);
+  // FIFO_SRC then 32 byte bursts of 5 samples, per sensor
+  uint32_t per_sensor = 1 + (LIS3DH_FIFO_SIZE + 4) / 5;
+  CHECK(sim_a.transactions + sim_b.transactions - before == 2 * per_sensor);
+  lis3dh_stats_t stats;
+  a.getStats(&stats);
+  CHECK(stats.fifoOverflows == 1);
+  b.getStats(&stats);
+  CHECK(stats.fifoOverflows == 1);
+  CHECK(sim_a.protocolErrors + sim_b.protocolErrors == 0);
+}
+
+static void test_gaps_and_overruns(void) {
+  LIS3DH_Sim sim;
+  sim.attachSPI(6);
+  Adafruit_LIS3DH lis(6);
+  CHECK(lis.begin());
+  lis.resetStats();
+
+  // read() now counts ZYXOR too
+  delay(10); // several samples at 400Hz, unread
+  lis.read();
+  lis.read();
+  lis3dh_stats_t stats;
+  lis.getStats(&stats);
+  CHECK(stats.overruns == 1);
+
+  // draining in time leaves no gaps
+  lis.setFIFOMode(LIS3DH_FIFO_STREAM);
+  lis3dh_sample_t samples[LIS3DH_FIFO_SIZE];
+  lis.resetStats();
+  for (uint8_t i = 0; i < 10; i++) {
+    delay(20);
+    lis.readFIFO(samples, LIS3DH_FIFO_SIZE);
+  }
+  lis.getStats(&stats);
+  CHECK(stats.gaps == 0);
+
+  // 40 samples into a 32 sample FIFO loses 8, give or take a period
+  delay(100);
+  lis.readFIFO(samples, LIS3DH_FIFO_SIZE);
+  lis.getStats(&stats);
+  CHECK((stats.gaps >= 7) && (stats.gaps <= 8));
+
+  // and a pause after resetStats() doesn't count
+  lis.resetStats();
+  delay(100);
+  lis.readFIFO(samples, LIS3DH_FIFO_SIZE);
+  lis.getStats(&stats);
+  CHECK(stats.gaps == 0);
+}
+
+static void test_filter(void) {
+  int16_t x[32], y[32], z[32];
+
+  // the IIR starts from the first sample rather than ramping up from 0,
+  // for negative inputs too
+  Adafruit_LIS3DH_Filter lowpass(3, 1);
+  for (uint8_t i = 0; i < 8; i++) {
+    x[i] = 1000;
+    y[i] = -1000;
+    z[i] = -1;
+  }
+  CHECK(lowpass.process(x, y, z, 8) == 8);
+  for (uint8_t i = 0; i < 8; i++)
+    CHECK((x[i] == 1000) && (y[i] == -1000) && (z[i] == -1));
+  // and then moves 1/8 of the way towards a step
+  for (uint8_t i = 0; i < 4; i++)
+    x[i] = y[i] = z[i] = 0;
+  lowpass.process(x, y, z, 4);
+  CHECK(x[0] == 875);
+  CHECK(y[0] == -875);
+  CHECK((x[3] < x[2]) && (y[3] > y[2]));
+
+  // decimating a ramp fed in uneven blocks matches one big block, with the
+  // phase carried across block boundaries and shared by every axis
+  Adafruit_LIS3DH_Filter decimate(0, 3);
+  const uint8_t blocks[] = {7, 1, 5, 2, 9, 6};
+  int16_t out[32];
+  uint8_t outputs = 0;
+  int16_t next = -40;
+  for (uint8_t b = 0; b < sizeof(blocks); b++) {
+    for (uint8_t i = 0; i < blocks[b]; i++, next++) {
+      x[i] = next;
+      y[i] = -next;
+      z[i] = 2 * next;
+    }
+    uint8_t n = decimate.process(x, y, z, blocks[b]);
+    for (uint8_t i = 0; i < n; i++) {
+      CHECK(y[i] == -x[i]);
+      CHECK(z[i] == 2 * x[i]);
+      out[outputs++] = x[i];
+    }
+  }
+  CHECK(outputs == 30 / 3);
+  for (uint8_t i = 0; i < outputs; i++) {
+    int32_t first = -40 + 3 * i;
+    CHECK(out[i] == (first * 3 + 3) / 3); // the average of the three
+  }
+
+  // averages truncate towards zero, as integer division does
+  Adafruit_LIS3DH_Filter quarter(0, 4);
+  int16_t a[4] = {-1, -2, -3, -4}, b[4] = {1, 2, 3, 4}, c[4] = {0};
+  CHECK(quarter.process(a, b, c, 4) == 1);
+  CHECK((a[0] == -2) && (b[0] == 2) && (c[0] == 0));
+}
+
+template <class Transport>
+static void check_lite(LIS3DH_Sim &sim, Adafruit_LIS3DH_Lite<Transport> &lis,
+                       uint8_t per_burst) {
+  sim.setReg(LIS3DH_REG_CTRL4, 0x40); // BLE, cleared by begin()
+  CHECK(lis.begin(LIS3DH_DATARATE_400_HZ, LIS3DH_RANGE_8_G));
+  CHECK(sim.reg(LIS3DH_REG_CTRL1) == 0x77);
+  CHECK(sim.reg(LIS3DH_REG_CTRL3) == LIS3DH_INT1_DRDY1);
+  CHECK(sim.reg(LIS3DH_REG_CTRL4) == 0xA8); // BDU, HR, 8G
+  CHECK(sim.reg(LIS3DH_REG_TEMPCFG) == 0x80);
+  CHECK_NEAR(lis.getScale(false), 4.0 / 16000, 1e-7);
+
+  int16_t xyz[LIS3DH_FIFO_SIZE * 3];
+  sim.setSample(-16000, 4000, 32000);
+  delay(5);
+  CHECK(lis.read(xyz));
+  CHECK((xyz[0] == -16000) && (xyz[1] == 4000) && (xyz[2] == 32000));
+
+  // readIfNew() is a single 7 byte transaction
+  uint32_t before = sim.transactions;
+  lis.readIfNew(xyz);
+  CHECK(sim.transactions - before == 1);
+  CHECK(!lis.readIfNew(xyz));
+  delay(3);
+  bool overrun = true;
+  CHECK(lis.readIfNew(xyz, &overrun));
+  CHECK(!overrun);
+
+  sim.setRamp(true);
+  CHECK(lis.setFIFOMode(LIS3DH_FIFO_STREAM));
+  uint32_t first = sim.generated;
+  delay(50); // 20 samples
+  before = sim.transactions;
+  uint8_t count = lis.readFIFO(xyz);
+  CHECK(count == 20);
+  CHECK(sim.transactions - before ==
+        (uint32_t)(1 + (count + per_burst - 1) / per_burst));
+  for (uint8_t i = 0; i < count; i++) {
+    CHECK(xyz[i * 3] == (int16_t)(first + i));
+    CHECK(xyz[i * 3 + 1] == (int16_t)-(first + i));
+  }
+  CHECK(sim.protocolErrors == 0);
+}
+
+static void test_lite(void) {
+  {
+    LIS3DH_Sim sim;
+    sim.attachI2C(0x19);
+    Adafruit_LIS3DH_Lite<LIS3DH_I2CTransport> lis(0x19);
+    check_lite(sim, lis, 5); // 32 byte I2C buffer
+  }
+  {
+    LIS3DH_Sim sim;
+    sim.attachSPI(5);
+    Adafruit_LIS3DH_Lite<LIS3DH_SPITransport> lis(5);
+    check_lite(sim, lis, LIS3DH_FIFO_SIZE);
+  }
+  {
+    LIS3DH_Sim sim; // nothing at 0x18
+    Adafruit_LIS3DH_Lite<LIS3DH_I2CTransport> lis;
+    CHECK(!lis.begin());
+  }
+}
+
+static void test_copy(void) {
+  LIS3DH_Sim sim;
+  sim.attachSPI(8);
+  Adafruit_LIS3DH lis = Adafruit_LIS3DH(8); // the examples' idiom
+  CHECK(lis.begin());
+
+  {
+    // a copy of a started sensor must not share (and later destroy) its
+    // SPI device; ASan reports a double free if it does
+    Adafruit_LIS3DH copy(lis);
+    CHECK(copy.getDeviceID() == 0); // no device until begin()
+    CHECK(copy.begin());
+    CHECK(copy.getDeviceID() == 0x33);
+  }
+  CHECK(lis.getDeviceID() == 0x33);
+  CHECK(lis.begin()); // and begin() again replaces the device in place
+  CHECK(lis.getDeviceID() == 0x33);
+}
+
+int main(void) {
+  RUN(test_begin_defaults);
+  RUN(test_begin_failures);
+  RUN(test_read_i2c);
+  RUN(test_read_spi);
+  RUN(test_read_if_new);
+  RUN(test_set_click);
+  RUN(test_tap_queue);
+  RUN(test_sample_ring);
+  RUN(test_fifo_stream);
+  RUN(test_fifo_watermark);
+  RUN(test_event_timestamps);
+  RUN(test_fifo_overrun);
+  RUN(test_capture_shock);
+  RUN(test_group);
+  RUN(test_gaps_and_overruns);
+  RUN(test_filter);
+  RUN(test_lite);
+  RUN(test_copy);
+
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("all tests passed\n");
+  return 0;
+}